@@ -0,0 +1,118 @@
+#include <benchmark/benchmark.h>
+#include <time.h>
+
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+
+#include "sync/clock.hpp"
+#include "sync/phase.hpp"
+
+namespace {
+
+/* Construct a cycle clock or skip the benchmark on platforms without a
+ * usable counter. */
+std::optional<gsync::CycleClock> MakeCycleClock(benchmark::State& state) {
+    try {
+        return gsync::CycleClock();
+    } catch (const std::runtime_error& e) {
+        state.SkipWithError(e.what());
+        return std::nullopt;
+    }
+}
+
+void BM_ClockGettimeMonotonic(benchmark::State& state) {
+    timespec now = {};
+    for (auto _ : state) {
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        benchmark::DoNotOptimize(now);
+    }
+}
+BENCHMARK(BM_ClockGettimeMonotonic);
+
+void BM_MonotonicClockNow(benchmark::State& state) {
+    gsync::MonotonicClock clock;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(clock.Now());
+    }
+}
+BENCHMARK(BM_MonotonicClockNow);
+
+void BM_ReadCycleCounter(benchmark::State& state) {
+    if (!gsync::kHasCycleCounter) {
+        state.SkipWithError("no user space cycle counter");
+        return;
+    }
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(gsync::ReadCycleCounter());
+    }
+}
+BENCHMARK(BM_ReadCycleCounter);
+
+void BM_CycleClockNowNano(benchmark::State& state) {
+    std::optional<gsync::CycleClock> clock = MakeCycleClock(state);
+    if (!clock) {
+        return;
+    }
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(clock->NowNano());
+    }
+    state.counters["recalibrations"] =
+        static_cast<double>(clock->Recalibrations());
+}
+BENCHMARK(BM_CycleClockNowNano);
+
+void BM_CycleClockNow(benchmark::State& state) {
+    std::optional<gsync::CycleClock> clock = MakeCycleClock(state);
+    if (!clock) {
+        return;
+    }
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(clock->Now());
+    }
+}
+BENCHMARK(BM_CycleClockNow);
+
+/* Track how far the cycle clock strays from CLOCK_MONOTONIC. Each iteration
+ * brackets a cycle clock reading between two clock_gettime() calls and
+ * records how far outside the bracket it landed, if at all. Run long enough
+ * to cross several recalibrations. */
+void BM_CycleClockError(benchmark::State& state) {
+    std::optional<gsync::CycleClock> clock = MakeCycleClock(state);
+    if (!clock) {
+        return;
+    }
+    const timespec kSpacing = {.tv_sec = 0, .tv_nsec = 1000000};
+    int64_t max_err = 0;
+    int64_t sum_err = 0;
+    int64_t samples = 0;
+    timespec before = {};
+    timespec after = {};
+    for (auto _ : state) {
+        clock_gettime(CLOCK_MONOTONIC, &before);
+        int64_t now = clock->NowNano();
+        clock_gettime(CLOCK_MONOTONIC, &after);
+
+        int64_t err = 0;
+        if (now < gsync::TsToNano(before)) {
+            err = gsync::TsToNano(before) - now;
+        } else if (now > gsync::TsToNano(after)) {
+            err = now - gsync::TsToNano(after);
+        }
+        max_err = (err > max_err) ? err : max_err;
+        sum_err += err;
+        samples++;
+
+        clock_nanosleep(CLOCK_MONOTONIC, 0, &kSpacing, NULL);
+    }
+    state.counters["max_err_ns"] = static_cast<double>(max_err);
+    state.counters["mean_err_ns"] =
+        (samples) ? (static_cast<double>(sum_err) /
+                     static_cast<double>(samples))
+                  : 0.0;
+    state.counters["recalibrations"] =
+        static_cast<double>(clock->Recalibrations());
+}
+BENCHMARK(BM_CycleClockError)->Iterations(3000)->UseRealTime();
+
+}  // namespace
@@ -0,0 +1,73 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdlib>
+#include <exception>
+#include <optional>
+#include <string>
+
+#include "util/gpio/gpio.hpp"
+
+namespace {
+
+/* The GPIO benchmarks need a line nobody else is using. By default, that's a
+ * line on a virtual GPIO bus. GSYNC_BENCH_GPIO_DEV and GSYNC_BENCH_GPIO_OFFSET
+ * select another one, e.g., one on a gpio-sim chip. */
+std::optional<gsync::Gpio> OpenBenchGpio(benchmark::State& state,
+                                         gsync::Gpio::Direction dir) {
+    const char* dev = std::getenv("GSYNC_BENCH_GPIO_DEV");
+    const char* offset = std::getenv("GSYNC_BENCH_GPIO_OFFSET");
+    if (!dev || !offset) {
+        dev = "vgpio:gsync_bench";
+        offset = "0";
+    }
+
+    try {
+        std::optional<gsync::Gpio> gpio(std::in_place, dev,
+                                        std::stoi(offset));
+        gpio->Dir(dir);
+        return gpio;
+    } catch (const std::exception& e) {
+        state.SkipWithError(e.what());
+        return std::nullopt;
+    }
+}
+
+void BM_GpioSetValue(benchmark::State& state) {
+    std::optional<gsync::Gpio> gpio =
+        OpenBenchGpio(state, gsync::Gpio::Direction::kOutput);
+    if (!gpio) {
+        return;
+    }
+    for (auto _ : state) {
+        gpio->Val(gsync::Gpio::Value::kHigh);
+        gpio->Val(gsync::Gpio::Value::kLow);
+    }
+    state.SetItemsProcessed(state.iterations() * 2);
+}
+BENCHMARK(BM_GpioSetValue);
+
+void BM_GpioGetValue(benchmark::State& state) {
+    std::optional<gsync::Gpio> gpio =
+        OpenBenchGpio(state, gsync::Gpio::Direction::kInput);
+    if (!gpio) {
+        return;
+    }
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(gpio->Val());
+    }
+}
+BENCHMARK(BM_GpioGetValue);
+
+void BM_GpioToggleOutput(benchmark::State& state) {
+    std::optional<gsync::Gpio> gpio =
+        OpenBenchGpio(state, gsync::Gpio::Direction::kOutput);
+    if (!gpio) {
+        return;
+    }
+    for (auto _ : state) {
+        gpio->ToggleOutput();
+    }
+}
+BENCHMARK(BM_GpioToggleOutput);
+
+}  // namespace
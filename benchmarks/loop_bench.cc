@@ -0,0 +1,187 @@
+#include <benchmark/benchmark.h>
+#include <time.h>
+
+#include <cstdint>
+#include <initializer_list>
+#include <optional>
+#include <stdexcept>
+#include <variant>
+
+#include "sync/clock.hpp"
+#include "sync/estimator.hpp"
+#include "sync/filter.hpp"
+#include "sync/loop.hpp"
+#include "sync/overrun.hpp"
+#include "sync/phase.hpp"
+#include "sync/pll.hpp"
+#include "sync/probe.hpp"
+#include "sync/rate.hpp"
+#include "sync/sync.hpp"
+#include "util/gpio/backend.hpp"
+#include "util/gpio/gpio.hpp"
+#include "util/gpio/resolve.hpp"
+#include "util/gpio/vgpio.hpp"
+#include "util/perf/perf.hpp"
+#include "util/perf/sections.hpp"
+#include "util/shmem/channel.hpp"
+#include "util/shmem/shmem.hpp"
+
+#include "loop_sim.hpp"
+
+namespace {
+
+using loop_sim::HandWrittenLoop;
+using loop_sim::LoopIo;
+using loop_sim::MakeClock;
+using loop_sim::MakeEstimator;
+using loop_sim::MakeFilter;
+using loop_sim::MakeLoopConfig;
+using loop_sim::MakeRate;
+using loop_sim::SimulatedPeer;
+
+/* Open the bench's own shared memory slot and vgpio line. */
+bool OpenIo(benchmark::State& state, LoopIo& io) {
+    try {
+        io.Open("gsync_bench_loop", loop_sim::ShmemKey(0x6c70));
+    } catch (const std::exception& e) {
+        state.SkipWithError(e.what());
+        return false;
+    }
+    return true;
+}
+
+/* Run a loop against a simulated peer in virtual time. */
+template <typename Loop>
+void RunLoop(benchmark::State& state, const gsync::VirtualClock& clock,
+             Loop& loop, gsync::IpShMemData<struct timespec>* peer) {
+    SimulatedPeer sim(clock.NowNano());
+    for (auto _ : state) {
+        sim.Publish(clock.NowNano(), peer);
+        loop.Step();
+    }
+
+    const gsync::LoopTelemetry& telemetry = loop.Telemetry();
+    state.SetItemsProcessed(static_cast<int64_t>(telemetry.cycles));
+    state.counters["tracked"] = benchmark::Counter(
+        static_cast<double>(telemetry.tracked_cycles) /
+        static_cast<double>(telemetry.cycles));
+    state.counters["phase_steps"] =
+        static_cast<double>(telemetry.phase_steps);
+}
+
+/* Run SyncLoop composed of the given policies. Line is either the concrete
+ * VirtualGpioBackend or the GpioBackend interface. */
+template <typename Line, typename Controller, typename Estimator,
+          typename Filter, typename Probe>
+void RunPolicyLoop(benchmark::State& state, Controller& sync,
+                   Estimator& estimator, Filter& filter, Probe& probe) {
+    LoopIo io;
+    if (!OpenIo(state, io)) {
+        return;
+    }
+    gsync::VirtualClock clock = MakeClock();
+    gsync::SkipOverrun overrun;
+    Line& line = *std::get<gsync::VirtualGpioBackend*>(
+        gsync::ResolveBackend(*io.gpio));
+    gsync::ShMemChannel channel(io.shmem->GetData());
+    gsync::SyncLoop loop(clock, sync, estimator, filter, overrun,
+                         MakeLoopConfig(), line, channel, probe);
+    RunLoop(state, clock, loop, io.shmem->GetData());
+}
+
+/* Run an uninstrumented SyncLoop. */
+template <typename Line, typename Controller, typename Estimator,
+          typename Filter>
+void RunPolicyLoop(benchmark::State& state, Controller& sync,
+                   Estimator& estimator, Filter& filter) {
+    gsync::NullProbe probe;
+    RunPolicyLoop<Line>(state, sync, estimator, filter, probe);
+}
+
+/* Run the hand-written baseline. */
+void RunHandWrittenLoop(benchmark::State& state, gsync::SyncController& sync,
+                        gsync::PeerEstimator* estimator,
+                        gsync::MadFilter* filter) {
+    LoopIo io;
+    if (!OpenIo(state, io)) {
+        return;
+    }
+    gsync::VirtualClock clock = MakeClock();
+    gsync::SkipOverrun overrun;
+    HandWrittenLoop loop(clock, sync, estimator, filter, overrun,
+                         MakeLoopConfig(), *io.gpio, io.shmem->GetData());
+    RunLoop(state, clock, loop, io.shmem->GetData());
+}
+
+void BM_SyncLoopKuramoto(benchmark::State& state) {
+    gsync::KuramotoSync sync(MakeRate(), 0.5);
+    gsync::NullEstimator estimator;
+    gsync::NullFilter filter;
+    RunPolicyLoop<gsync::VirtualGpioBackend>(state, sync, estimator, filter);
+}
+BENCHMARK(BM_SyncLoopKuramoto);
+
+void BM_SyncLoopPll(benchmark::State& state) {
+    gsync::PllSync sync(MakeRate(), 0.25, 0.02);
+    gsync::NullEstimator estimator;
+    gsync::NullFilter filter;
+    RunPolicyLoop<gsync::VirtualGpioBackend>(state, sync, estimator, filter);
+}
+BENCHMARK(BM_SyncLoopPll);
+
+/* The cost of instrumenting every section with hardware counters. */
+void BM_SyncLoopPllPerfProbe(benchmark::State& state) {
+    std::optional<gsync::SectionCounters> counters;
+    try {
+        counters.emplace(std::initializer_list<gsync::PerfCounter::Event>{
+            gsync::PerfCounter::Event::kCycles,
+            gsync::PerfCounter::Event::kInstructions,
+            gsync::PerfCounter::Event::kCacheMisses,
+            gsync::PerfCounter::Event::kBranchMisses,
+        });
+    } catch (const std::runtime_error& e) {
+        state.SkipWithError(e.what());
+        return;
+    }
+    gsync::PllSync sync(MakeRate(), 0.25, 0.02);
+    gsync::NullEstimator estimator;
+    gsync::NullFilter filter;
+    gsync::PerfProbe probe(*counters);
+    RunPolicyLoop<gsync::VirtualGpioBackend>(state, sync, estimator, filter,
+                                             probe);
+    state.counters["rdpmc"] = (counters->UserReadable()) ? 1.0 : 0.0;
+}
+BENCHMARK(BM_SyncLoopPllPerfProbe);
+
+void BM_SyncLoopPllVirtual(benchmark::State& state) {
+    gsync::PllSync pll(MakeRate(), 0.25, 0.02);
+    gsync::SyncController& sync = pll;
+    gsync::NullEstimator estimator;
+    gsync::NullFilter filter;
+    RunPolicyLoop<gsync::GpioBackend>(state, sync, estimator, filter);
+}
+BENCHMARK(BM_SyncLoopPllVirtual);
+
+void BM_HandWrittenLoopPll(benchmark::State& state) {
+    gsync::PllSync sync(MakeRate(), 0.25, 0.02);
+    RunHandWrittenLoop(state, sync, nullptr, nullptr);
+}
+BENCHMARK(BM_HandWrittenLoopPll);
+
+void BM_SyncLoopPllEstimatorMad(benchmark::State& state) {
+    gsync::PllSync sync(MakeRate(), 0.25, 0.02);
+    gsync::PeerEstimator estimator = MakeEstimator();
+    gsync::MadFilter filter = MakeFilter();
+    RunPolicyLoop<gsync::VirtualGpioBackend>(state, sync, estimator, filter);
+}
+BENCHMARK(BM_SyncLoopPllEstimatorMad);
+
+void BM_HandWrittenLoopPllEstimatorMad(benchmark::State& state) {
+    gsync::PllSync sync(MakeRate(), 0.25, 0.02);
+    gsync::PeerEstimator estimator = MakeEstimator();
+    gsync::MadFilter filter = MakeFilter();
+    RunHandWrittenLoop(state, sync, &estimator, &filter);
+}
+BENCHMARK(BM_HandWrittenLoopPllEstimatorMad);
+
+}  // namespace
@@ -0,0 +1,59 @@
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <exception>
+#include <memory>
+
+#include "util/mem/arena.hpp"
+#include "util/mem/mem.hpp"
+
+namespace {
+
+/* The stack's pages stay mapped after the first iteration. This measures the
+ * cost of touching an already faulted in stack. */
+void BM_PrefaultStack(benchmark::State& state) {
+    for (auto _ : state) {
+        gsync::mem::PrefaultStack(static_cast<std::size_t>(state.range(0)));
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_PrefaultStack)->Arg(64 << 10)->Arg(512 << 10);
+
+/* Without ConfigureMallocForRt(), allocations this large are mmap()ed and
+ * handed back to the kernel on free, so every iteration pays for faulting
+ * the pages in again. */
+void BM_PrefaultHeap(benchmark::State& state) {
+    for (auto _ : state) {
+        gsync::mem::PrefaultHeap(static_cast<std::size_t>(state.range(0)));
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_PrefaultHeap)->Arg(1 << 20)->Arg(8 << 20);
+
+void BM_HeapAllocate(benchmark::State& state) {
+    for (auto _ : state) {
+        std::unique_ptr<unsigned char[]> p(
+            new unsigned char[static_cast<std::size_t>(state.range(0))]);
+        benchmark::DoNotOptimize(p.get());
+    }
+}
+BENCHMARK(BM_HeapAllocate)->Arg(64)->Arg(4096);
+
+void BM_LockedArenaAllocate(benchmark::State& state) {
+    const std::size_t kArenaSize = 1 << 20;
+    const std::size_t kBytes = static_cast<std::size_t>(state.range(0));
+    try {
+        gsync::mem::LockedArena arena(
+            kArenaSize, gsync::mem::LockedArena::Strategy::kPool);
+        for (auto _ : state) {
+            void* p = arena.allocate(kBytes);
+            benchmark::DoNotOptimize(p);
+            arena.deallocate(p, kBytes);
+        }
+    } catch (const std::exception& e) {
+        state.SkipWithError(e.what());
+    }
+}
+BENCHMARK(BM_LockedArenaAllocate)->Arg(64)->Arg(4096);
+
+}  // namespace
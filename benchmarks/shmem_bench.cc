@@ -0,0 +1,110 @@
+#include <benchmark/benchmark.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstdint>
+
+#include "util/shmem/shmem.hpp"
+
+namespace {
+
+/* Key for the benchmark's own segment. It must not collide with a running
+ * gtimer. */
+int BenchShmemKey() { return 0x6273 + static_cast<int>(getpid() % 1000); }
+
+/* Single writer sequence lock, the lock free alternative to the mutex that
+ * IpShMemData uses. Readers retry if they raced a write. */
+struct SeqLockTimespec {
+    std::atomic<uint32_t> seq = 0;
+    std::atomic<int64_t> sec = 0;
+    std::atomic<int64_t> nsec = 0;
+
+    void Store(const timespec& ts) {
+        uint32_t s = seq.load(std::memory_order_relaxed);
+        seq.store(s + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        sec.store(ts.tv_sec, std::memory_order_relaxed);
+        nsec.store(ts.tv_nsec, std::memory_order_relaxed);
+        seq.store(s + 2, std::memory_order_release);
+    }
+
+    timespec Load() const {
+        timespec ts = {};
+        uint32_t before = 0;
+        uint32_t after = 0;
+        do {
+            before = seq.load(std::memory_order_acquire);
+            ts.tv_sec = sec.load(std::memory_order_relaxed);
+            ts.tv_nsec = nsec.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            after = seq.load(std::memory_order_relaxed);
+        } while ((before & 1) || (before != after));
+        return ts;
+    }
+};
+
+void BM_IpShMemLockedWrite(benchmark::State& state) {
+    gsync::IpShMem<timespec> shmem(BenchShmemKey());
+    gsync::IpShMemData<timespec>* data = shmem.GetData();
+    for (auto _ : state) {
+        data->Lock();
+        clock_gettime(CLOCK_MONOTONIC, &data->data);
+        data->Unlock();
+    }
+}
+BENCHMARK(BM_IpShMemLockedWrite);
+
+void BM_IpShMemLockedRead(benchmark::State& state) {
+    gsync::IpShMem<timespec> shmem(BenchShmemKey());
+    gsync::IpShMemData<timespec>* data = shmem.GetData();
+    for (auto _ : state) {
+        data->Lock();
+        timespec ts = data->data;
+        data->Unlock();
+        benchmark::DoNotOptimize(ts);
+    }
+}
+BENCHMARK(BM_IpShMemLockedRead);
+
+void BM_SeqLockWrite(benchmark::State& state) {
+    SeqLockTimespec seqlock;
+    timespec ts = {};
+    for (auto _ : state) {
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        seqlock.Store(ts);
+    }
+    benchmark::DoNotOptimize(seqlock);
+}
+BENCHMARK(BM_SeqLockWrite);
+
+void BM_SeqLockRead(benchmark::State& state) {
+    SeqLockTimespec seqlock;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(seqlock.Load());
+    }
+}
+BENCHMARK(BM_SeqLockRead);
+
+/* A single 64-bit nanosecond timestamp needs no lock at all. */
+void BM_AtomicNanoWrite(benchmark::State& state) {
+    std::atomic<int64_t> nano = 0;
+    timespec ts = {};
+    for (auto _ : state) {
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        nano.store(ts.tv_sec * 1000000000LL + ts.tv_nsec,
+                   std::memory_order_release);
+    }
+    benchmark::DoNotOptimize(nano);
+}
+BENCHMARK(BM_AtomicNanoWrite);
+
+void BM_AtomicNanoRead(benchmark::State& state) {
+    std::atomic<int64_t> nano = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(nano.load(std::memory_order_acquire));
+    }
+}
+BENCHMARK(BM_AtomicNanoRead);
+
+}  // namespace
@@ -0,0 +1,135 @@
+#include <benchmark/benchmark.h>
+#include <time.h>
+
+#include <cstdint>
+
+#include "sync/adaptive.hpp"
+#include "sync/estimator.hpp"
+#include "sync/filter.hpp"
+#include "sync/fixed_sync.hpp"
+#include "sync/phase.hpp"
+#include "sync/pll.hpp"
+#include "sync/rate.hpp"
+#include "sync/sync.hpp"
+
+namespace {
+
+const int64_t kPeriodNano = 10000000; /* 100 Hz. */
+
+/* Deterministic jitter source so that every run sees the same inputs. */
+class Jitter {
+   public:
+    int64_t Next() {
+        state_ = state_ * 6364136223846793005ULL + 1442695040888963407ULL;
+        return static_cast<int64_t>(state_ >> 48) - 32768;
+    }
+
+   private:
+    uint64_t state_ = 1;
+};
+
+/* Drive a controller with a peer that trails us by a jittery offset. */
+void RunController(benchmark::State& state, gsync::SyncController& sync) {
+    Jitter jitter;
+    int64_t actual = gsync::kNanoPerSec;
+    for (auto _ : state) {
+        timespec wakeup = sync.ComputeNewWakeup(
+            gsync::NanoToTs(actual),
+            gsync::NanoToTs(actual + 100000 + jitter.Next()));
+        benchmark::DoNotOptimize(wakeup);
+        actual += kPeriodNano;
+    }
+}
+
+void BM_KuramotoComputeNewWakeup(benchmark::State& state) {
+    gsync::KuramotoSync sync(gsync::SyncRate::FromPeriodNs(kPeriodNano), 0.5);
+    RunController(state, sync);
+}
+BENCHMARK(BM_KuramotoComputeNewWakeup);
+
+void BM_KuramotoAdaptiveComputeNewWakeup(benchmark::State& state) {
+    gsync::AdaptiveKuramotoSync sync(
+        gsync::SyncRate::FromPeriodNs(kPeriodNano),
+        gsync::AdaptiveCoupling::Config{
+            .k_min = 0.1,
+            .k_max = 1.0,
+            .decay = 0.98,
+        });
+    RunController(state, sync);
+}
+BENCHMARK(BM_KuramotoAdaptiveComputeNewWakeup);
+
+void BM_KuramotoRationalComputeNewWakeup(benchmark::State& state) {
+    gsync::KuramotoSync sync(gsync::SyncRate::FromHz(30000, 1001), 0.5);
+    RunController(state, sync);
+}
+BENCHMARK(BM_KuramotoRationalComputeNewWakeup);
+
+void BM_FixedKuramotoComputeNewWakeup(benchmark::State& state) {
+    gsync::FixedKuramotoSync<kPeriodNano> sync(0.5);
+    RunController(state, sync);
+}
+BENCHMARK(BM_FixedKuramotoComputeNewWakeup);
+
+void BM_PllComputeNewWakeup(benchmark::State& state) {
+    gsync::PllSync sync(gsync::SyncRate::FromPeriodNs(kPeriodNano), 0.25,
+                        0.02);
+    RunController(state, sync);
+}
+BENCHMARK(BM_PllComputeNewWakeup);
+
+void BM_PeerEstimatorUpdate(benchmark::State& state) {
+    gsync::PeerEstimator estimator(gsync::SyncRate::FromPeriodNs(kPeriodNano),
+                                   gsync::PeerEstimator::Config{
+                                       .measurement_noise_ns = 20000.0,
+                                       .phase_noise_ns = 2000.0,
+                                       .period_noise_ns = 20.0,
+                                   });
+    Jitter jitter;
+    int64_t peer = gsync::kNanoPerSec;
+    for (auto _ : state) {
+        timespec estimate =
+            estimator.Update(gsync::NanoToTs(peer + jitter.Next()));
+        benchmark::DoNotOptimize(estimate);
+        peer += kPeriodNano;
+    }
+}
+BENCHMARK(BM_PeerEstimatorUpdate);
+
+/* Feed a filter jittery phase errors. */
+template <typename Filter>
+void RunFilter(benchmark::State& state, Filter& filter) {
+    Jitter jitter;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(filter.Filter(jitter.Next()));
+    }
+}
+
+void BM_MedianFilter(benchmark::State& state) {
+    gsync::MedianFilter filter(static_cast<std::size_t>(state.range(0)));
+    RunFilter(state, filter);
+}
+BENCHMARK(BM_MedianFilter)->ArgName("window")->Arg(5);
+
+void BM_MadFilter(benchmark::State& state) {
+    gsync::MadFilter filter(static_cast<std::size_t>(state.range(0)), 3.0);
+    RunFilter(state, filter);
+}
+BENCHMARK(BM_MadFilter)->ArgName("window")->Arg(5)->Arg(15);
+
+/* The cost of handing out a dithered period. The schedule itself is checked
+ * by tests/rate_check.cc. */
+void BM_SyncRateNextPeriod(benchmark::State& state) {
+    gsync::SyncRate rate = gsync::SyncRate::FromHz(state.range(0),
+                                                   state.range(1));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(rate.NextPeriod());
+    }
+}
+BENCHMARK(BM_SyncRateNextPeriod)
+    ->ArgNames({"num", "den"})
+    ->Args({2997, 100})
+    ->Args({30000, 1001})
+    ->Args({10000, 1});
+
+}  // namespace
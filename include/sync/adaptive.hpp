@@ -0,0 +1,121 @@
+#ifndef ADAPTIVE_H_
+#define ADAPTIVE_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace gsync {
+
+/**
+ * Self-tuning Kuramoto coupling constant.
+ *
+ * AdaptiveCoupling starts with a large coupling constant so that a fresh peer
+ * is pulled in quickly. It tracks the running mean and variance of the phase
+ * error. While the error is dominated by a systematic offset (the loop is
+ * still acquiring or the peer is drifting away) the target stays high. Once
+ * the error is dominated by zero mean jitter, the target falls towards the
+ * lower bound so that the loop stops amplifying that jitter. A phase error far
+ * outside of the measured distribution (e.g., the peer restarted) snaps the
+ * coupling constant back to its upper bound.
+ *
+ * Changes in the coupling constant are recorded in a fixed size trajectory
+ * log which can be dumped after the event loop exits.
+ */
+class AdaptiveCoupling {
+   public:
+    /** Adaptation parameters. */
+    struct Config {
+        double k_min; /**< Lower bound, the steady-state coupling constant. */
+        double k_max; /**< Upper bound, the acquisition coupling constant. */
+        double decay; /**< Per cycle decay of K towards its target in the
+                         range (0, 1). Smaller is faster. */
+    };
+
+    /** A point on the coupling constant trajectory. */
+    struct Sample {
+        uint64_t cycle;       /**< Cycle at which the sample was taken. */
+        double k;             /**< Coupling constant. */
+        double error_mean;    /**< Mean phase error in radians. */
+        double error_stddev;  /**< Phase error std deviation in radians. */
+        bool reacquire;       /**< True if a reacquisition was triggered. */
+    };
+
+    static const std::size_t kTrajectorySize = 64; /**< Log capacity. */
+
+    /**
+     * Construct an adaptive coupling constant.
+     *
+     * @param[in] config Adaptation parameters.
+     *
+     * @throws std::runtime_error
+     */
+    explicit AdaptiveCoupling(const Config& config);
+
+    /* The default copy/move constructors and assignment methods will work for
+     * objects of this class. */
+    AdaptiveCoupling() = delete;
+    ~AdaptiveCoupling() = default;
+    AdaptiveCoupling(const AdaptiveCoupling&) = default;
+    AdaptiveCoupling& operator=(const AdaptiveCoupling&) = default;
+    AdaptiveCoupling(AdaptiveCoupling&&) = default;
+    AdaptiveCoupling& operator=(AdaptiveCoupling&&) = default;
+
+    /**
+     * Fold the latest phase error into the statistics and adapt K.
+     *
+     * @param[in] phase_error The wrapped phase error in radians.
+     *
+     * @returns The coupling constant to use for this cycle.
+     */
+    double Update(double phase_error);
+
+    /** Return the current coupling constant. */
+    double K() const { return k_; }
+
+    /** Return the number of reacquisitions triggered so far. */
+    uint64_t Reacquisitions() const { return reacquisitions_; }
+
+    /** Return the number of samples in the trajectory log. */
+    std::size_t TrajectoryLen() const {
+        return (logged_ < kTrajectorySize) ? logged_ : kTrajectorySize;
+    }
+
+    /**
+     * Return a trajectory sample.
+     *
+     * @param[in] i Index in the range [0, TrajectoryLen()) where 0 is the
+     * oldest sample still in the log.
+     */
+    const Sample& TrajectoryAt(std::size_t i) const;
+
+   private:
+    /** EWMA weight of the phase error statistics. */
+    static constexpr double kStatsAlpha = 1.0 / 16.0;
+
+    /** Errors further than this many standard deviations from the mean
+     * trigger a reacquisition... */
+    static constexpr double kReacquireSigma = 6.0;
+
+    /** ...as long as they are also larger than this many radians. */
+    static constexpr double kReacquireFloor = 0.1;
+
+    /** Relative change in K which is worth a trajectory log entry. */
+    static constexpr double kLogThreshold = 0.1;
+
+    void Log(bool reacquire);
+
+    Config config_;
+    double k_;
+    double mean_;
+    double var_;
+    uint64_t cycle_;
+    uint64_t reacquisitions_;
+    double last_logged_k_;
+    std::size_t logged_;
+    std::array<Sample, kTrajectorySize> trajectory_;
+};
+
+}  // namespace gsync
+
+#endif
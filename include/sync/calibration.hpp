@@ -0,0 +1,112 @@
+#ifndef CALIBRATION_H_
+#define CALIBRATION_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+namespace gsync {
+
+/**
+ * Capture latency calibration.
+ *
+ * The peer wakeup time gtimer records includes the wire delay, the GPIO IRQ
+ * latency and the driver latency. LatencyCalibration collects round trip
+ * times measured by echoing an edge off of the peer over the cross wired GPIO
+ * lines and estimates the one-way latency as half of the median round trip.
+ * The median is used rather than the mean so that the occasional scheduling
+ * hiccup during calibration doesn't skew the correction.
+ */
+class LatencyCalibration {
+   public:
+    /** Round trip statistics in nanoseconds. */
+    struct Stats {
+        std::size_t count; /**< Number of round trips. */
+        int64_t min;       /**< Shortest round trip. */
+        int64_t max;       /**< Longest round trip. */
+        int64_t median;    /**< Median round trip. */
+        double mean;       /**< Mean round trip. */
+        double stddev;     /**< Round trip standard deviation. */
+    };
+
+    /**
+     * Construct a latency calibration.
+     *
+     * @param[in] capacity Maximum number of round trips that will be
+     * recorded. Storage is reserved up front.
+     * @param[in] resource Memory resource the round trips are stored in, e.g.,
+     * a mem::LockedArena.
+     *
+     * @throws std::runtime_error
+     */
+    explicit LatencyCalibration(
+        std::size_t capacity,
+        std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+    /* The default copy/move constructors and assignment methods will work for
+     * objects of this class. */
+    LatencyCalibration() = delete;
+    ~LatencyCalibration() = default;
+    LatencyCalibration(const LatencyCalibration&) = default;
+    LatencyCalibration& operator=(const LatencyCalibration&) = default;
+    LatencyCalibration(LatencyCalibration&&) = default;
+    LatencyCalibration& operator=(LatencyCalibration&&) = default;
+
+    /**
+     * Record a round trip.
+     *
+     * @param[in] rtt_ns Round trip time in nanoseconds. Non-positive values
+     * and values recorded after capacity is reached are dropped.
+     *
+     * @returns true if the sample was recorded.
+     */
+    bool AddRoundTrip(int64_t rtt_ns);
+
+    /** Return the number of recorded round trips. */
+    std::size_t Count() const { return rtts_.size(); }
+
+    /**
+     * Compute round trip statistics.
+     *
+     * @throws std::runtime_error
+     */
+    Stats RoundTripStats() const;
+
+    /**
+     * Return the estimated one-way latency in nanoseconds.
+     *
+     * @throws std::runtime_error
+     */
+    int64_t OneWayLatency() const { return (RoundTripStats().median / 2); }
+
+   private:
+    std::size_t capacity_;
+    std::pmr::vector<int64_t> rtts_;
+};
+
+/**
+ * Save a one-way latency correction to disk.
+ *
+ * @param[in] path Path to the calibration file.
+ * @param[in] latency_ns One-way latency in nanoseconds.
+ *
+ * @throws std::runtime_error
+ */
+void SaveLatency(const std::string& path, int64_t latency_ns);
+
+/**
+ * Load a one-way latency correction from disk.
+ *
+ * @param[in] path Path to the calibration file.
+ *
+ * @returns One-way latency in nanoseconds.
+ *
+ * @throws std::runtime_error
+ */
+int64_t LoadLatency(const std::string& path);
+
+}  // namespace gsync
+
+#endif
@@ -0,0 +1,274 @@
+#ifndef CLOCK_H_
+#define CLOCK_H_
+
+#include <errno.h>
+#include <time.h>
+
+#include <atomic>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "sync/phase.hpp"
+
+namespace gsync {
+
+/* Clock policies for SyncLoop, see ClockPolicy in policy.hpp. */
+
+/**
+ * Sleep until the absolute CLOCK_MONOTONIC time \p wakeup.
+ *
+ * A signal, e.g., a SIGUSR1 telemetry request, interrupts
+ * \a clock_nanosleep() and SA_RESTART never restarts it. The sleep is
+ * resumed unless \p stop is set, so that a signal can't pull a wakeup in.
+ */
+inline void SleepUntilMonotonic(const timespec& wakeup,
+                                const std::atomic_bool* stop) {
+    while ((EINTR == clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wakeup,
+                                     NULL)) &&
+           !(stop && *stop)) {
+    }
+}
+
+/** Real time clock policy backed by CLOCK_MONOTONIC. */
+class MonotonicClock {
+   public:
+    /**
+     * Construct a clock.
+     *
+     * @param[in] stop Flag checked when a signal interrupts a sleep. The
+     * sleep returns early if the flag is set and resumes otherwise. May be
+     * NULL.
+     */
+    explicit MonotonicClock(const std::atomic_bool* stop = nullptr)
+        : stop_(stop) {}
+
+    /* The default copy/move constructors and assignment methods will work for
+     * objects of this class. */
+    ~MonotonicClock() = default;
+    MonotonicClock(const MonotonicClock&) = default;
+    MonotonicClock& operator=(const MonotonicClock&) = default;
+    MonotonicClock(MonotonicClock&&) = default;
+    MonotonicClock& operator=(MonotonicClock&&) = default;
+
+    /** Return the current CLOCK_MONOTONIC time. */
+    timespec Now() {
+        timespec now = {};
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        return now;
+    }
+
+    /** Sleep until the absolute CLOCK_MONOTONIC time \p wakeup. */
+    void SleepUntil(const timespec& wakeup) {
+        SleepUntilMonotonic(wakeup, stop_);
+    }
+
+   private:
+    const std::atomic_bool* stop_;
+};
+
+/**
+ * Virtual time clock policy.
+ *
+ * Time only moves when the loop sleeps or when the owner advances it, so a
+ * SyncLoop driven by a VirtualClock runs as fast as the CPU allows and
+ * produces the same schedule on every run. Each sleep overshoots its target
+ * by a fixed wakeup latency to stand in for the scheduler.
+ */
+class VirtualClock {
+   public:
+    /**
+     * Construct a virtual clock.
+     *
+     * @param[in] start_ns Initial time in nanoseconds.
+     * @param[in] wakeup_latency_ns Time by which every sleep overshoots its
+     * target.
+     */
+    explicit VirtualClock(int64_t start_ns = kNanoPerSec,
+                          int64_t wakeup_latency_ns = 0)
+        : now_ns_(start_ns), wakeup_latency_ns_(wakeup_latency_ns) {}
+
+    /* The default copy/move constructors and assignment methods will work for
+     * objects of this class. */
+    ~VirtualClock() = default;
+    VirtualClock(const VirtualClock&) = default;
+    VirtualClock& operator=(const VirtualClock&) = default;
+    VirtualClock(VirtualClock&&) = default;
+    VirtualClock& operator=(VirtualClock&&) = default;
+
+    /** Return the current virtual time. */
+    timespec Now() { return NanoToTs(now_ns_); }
+
+    /** Return the current virtual time in nanoseconds. */
+    int64_t NowNano() const { return now_ns_; }
+
+    /**
+     * Jump to \p wakeup plus the wakeup latency. A wakeup in the past
+     * returns right away, after the wakeup latency, like \a clock_nanosleep()
+     * does.
+     */
+    void SleepUntil(const timespec& wakeup) {
+        int64_t wakeup_ns = TsToNano(wakeup);
+        if (wakeup_ns > now_ns_) {
+            now_ns_ = wakeup_ns;
+        }
+        now_ns_ += wakeup_latency_ns_;
+    }
+
+    /** Move time forward by \p ns nanoseconds, e.g., to emulate a stall. */
+    void Advance(int64_t ns) { now_ns_ += ns; }
+
+   private:
+    int64_t now_ns_;
+    int64_t wakeup_latency_ns_;
+};
+
+/** Whether this build can read a cycle counter from user space. */
+#if defined(__x86_64__) || defined(__i386__) || defined(__aarch64__) || \
+    (defined(__arm__) && defined(GSYNC_ARM_CNTVCT))
+static constexpr bool kHasCycleCounter = true;
+#else
+static constexpr bool kHasCycleCounter = false;
+#endif
+
+/**
+ * Read the free running cycle counter: the TSC on x86, CNTVCT (the ARM
+ * generic timer's virtual count) on ARM. Returns 0 where kHasCycleCounter is
+ * false.
+ *
+ * On 32-bit ARM, user space can only read CNTVCT if the kernel enabled it, so
+ * the read is compiled in only when GSYNC_ARM_CNTVCT is defined. Otherwise it
+ * would raise SIGILL.
+ */
+inline uint64_t ReadCycleCounter() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#elif defined(__aarch64__)
+    uint64_t ticks = 0;
+    asm volatile("isb\n\tmrs %0, cntvct_el0" : "=r"(ticks) : : "memory");
+    return ticks;
+#elif defined(__arm__) && defined(GSYNC_ARM_CNTVCT)
+    uint64_t ticks = 0;
+    asm volatile("isb\n\tmrrc p15, 1, %Q0, %R0, c14"
+                 : "=r"(ticks)
+                 :
+                 : "memory");
+    return ticks;
+#else
+    return 0;
+#endif
+}
+
+/**
+ * Clock policy that reads the cycle counter rather than calling
+ * \a clock_gettime().
+ *
+ * Timestamps are on the CLOCK_MONOTONIC timeline so that they mix with
+ * timestamps taken by MonotonicClock, e.g., in the other process on the end
+ * of gtimer's shared memory slot. The clock keeps a fixed point
+ * nanoseconds-per-tick conversion anchored to a CLOCK_MONOTONIC reading.
+ * Once per recalibration interval, Now() takes a fresh CLOCK_MONOTONIC
+ * reading and retunes the conversion. Any offset that built up is slewed out
+ * over the next interval rather than stepped, so the clock never runs
+ * backwards. The first intervals are short and double up to the
+ * recalibration interval so that the rate measured at construction, over a
+ * few milliseconds, is refined quickly. All other calls to Now() are a
+ * counter read, a multiply and a shift.
+ *
+ * SleepUntil() sleeps on CLOCK_MONOTONIC like MonotonicClock does.
+ *
+ * A CycleClock must only be used by one thread.
+ */
+class CycleClock {
+   public:
+    /** Default interval between recalibrations. */
+    static constexpr int64_t kDefaultRecalibrationNs = kNanoPerSec;
+
+    /**
+     * Construct a clock and measure the counter's rate against
+     * CLOCK_MONOTONIC. Construction blocks for a few milliseconds.
+     *
+     * @param[in] recalibration_ns Interval between recalibrations, at most
+     * two seconds.
+     * @param[in] stop Flag checked when a signal interrupts a sleep, see
+     * MonotonicClock. May be NULL.
+     *
+     * @throws std::runtime_error
+     */
+    explicit CycleClock(int64_t recalibration_ns = kDefaultRecalibrationNs,
+                        const std::atomic_bool* stop = nullptr);
+
+    /* The default copy/move constructors and assignment methods will work for
+     * objects of this class. */
+    ~CycleClock() = default;
+    CycleClock(const CycleClock&) = default;
+    CycleClock& operator=(const CycleClock&) = default;
+    CycleClock(CycleClock&&) = default;
+    CycleClock& operator=(CycleClock&&) = default;
+
+    /** Return the current time on the CLOCK_MONOTONIC timeline. */
+    timespec Now() { return NanoToTs(NowNano()); }
+
+    /** Return the current time on the CLOCK_MONOTONIC timeline in ns. */
+    int64_t NowNano() {
+        uint64_t ticks = ReadCycleCounter() - base_ticks_;
+        if (ticks >= recalibration_ticks_) [[unlikely]] {
+            Recalibrate();
+            ticks = ReadCycleCounter() - base_ticks_;
+        }
+        return base_ns_ + static_cast<int64_t>((ticks * mult_) >> kShift);
+    }
+
+    /** Sleep until the absolute CLOCK_MONOTONIC time \p wakeup. */
+    void SleepUntil(const timespec& wakeup) {
+        SleepUntilMonotonic(wakeup, stop_);
+    }
+
+    /** Return the measured counter frequency in Hz. */
+    double FrequencyHz() const;
+
+    /** Return the number of recalibrations run. */
+    uint64_t Recalibrations() const { return recalibrations_; }
+
+    /**
+     * Return the offset from CLOCK_MONOTONIC found by the last
+     * recalibration, in nanoseconds. A positive value means the clock was
+     * behind.
+     */
+    int64_t LastOffsetNs() const { return last_offset_ns_; }
+
+   private:
+    /* Ticks are converted to nanoseconds as (ticks * mult_) >> kShift. The
+     * tick count is bounded by the recalibration interval, which is bounded
+     * to two seconds, so the product fits in 64 bits at any counter
+     * frequency, slew included. */
+    static constexpr int kShift = 32;
+
+    /** A counter reading paired with a CLOCK_MONOTONIC reading. */
+    struct Sample {
+        uint64_t ticks;
+        int64_t mono_ns;
+    };
+
+    static Sample TakeSample();
+
+    void Recalibrate();
+
+    uint64_t base_ticks_;
+    int64_t base_ns_;
+    uint64_t mult_;
+    uint64_t recalibration_ticks_;
+    int64_t recalibration_ns_;
+    int64_t interval_ns_;
+    double ns_per_tick_;
+    Sample last_sample_;
+    uint64_t recalibrations_;
+    int64_t last_offset_ns_;
+    const std::atomic_bool* stop_;
+};
+
+}  // namespace gsync
+
+#endif
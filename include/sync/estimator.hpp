@@ -0,0 +1,116 @@
+#ifndef ESTIMATOR_H_
+#define ESTIMATOR_H_
+
+#include <time.h>
+
+#include <cstdint>
+
+#include "sync/rate.hpp"
+
+namespace gsync {
+
+/**
+ * Online estimator of the peer's phase and period.
+ *
+ * PeerEstimator runs a two state (phase, period) Kalman filter over the stream
+ * of peer wakeup timestamps captured by gtimer. Each update is O(1) and
+ * allocates nothing. The filtered edge time can be handed to a SyncController
+ * in place of the raw sample so that wakeup jitter on the peer is not copied
+ * straight into our own schedule.
+ *
+ * Internally, time is kept relative to the last measurement so that the
+ * floating point state never has to represent an absolute CLOCK_MONOTONIC
+ * value.
+ */
+class PeerEstimator {
+   public:
+    /** Filter noise model. All values are standard deviations. */
+    struct Config {
+        double measurement_noise_ns; /**< Jitter on each captured edge. */
+        double phase_noise_ns; /**< Per cycle random walk of the peer's phase,
+                                  e.g., corrections made by its controller. */
+        double period_noise_ns; /**< Per cycle random walk of the peer's
+                                   period, i.e., oscillator wander. */
+    };
+
+    /**
+     * Construct a peer estimator.
+     *
+     * @param[in] rate Nominal rate of the peer.
+     * @param[in] config Filter noise model.
+     *
+     * @throws std::runtime_error
+     */
+    PeerEstimator(const SyncRate& rate, const Config& config);
+
+    /* The default copy/move constructors and assignment methods will work for
+     * objects of this class. */
+    PeerEstimator() = delete;
+    ~PeerEstimator() = default;
+    PeerEstimator(const PeerEstimator&) = default;
+    PeerEstimator& operator=(const PeerEstimator&) = default;
+    PeerEstimator(PeerEstimator&&) = default;
+    PeerEstimator& operator=(PeerEstimator&&) = default;
+
+    /**
+     * Fold a new peer wakeup sample into the estimate.
+     *
+     * Samples that are too far from the prediction (e.g., the peer restarted
+     * or was offline for several cycles) reinitialize the filter.
+     *
+     * @param[in] peer_wakeup The latest wakeup time reported by the peer.
+     *
+     * @returns The filtered estimate of the peer's latest wakeup time.
+     */
+    timespec Update(const timespec& peer_wakeup);
+
+    /** Discard all state. The next sample reinitializes the filter. */
+    void Reset() { initialized_ = false; }
+
+    /** Return the estimated peer period in nanoseconds. */
+    double Period() const { return period_; }
+
+    /** Return the number of times the filter was (re)initialized. */
+    uint64_t Reinits() const { return reinits_; }
+
+   private:
+    /** Number of missed cycles after which the prediction is discarded. */
+    static const int64_t kMaxGapCycles = 16;
+
+    /** Innovation, as a fraction of the period, which is treated as a jump in
+     * the peer's phase rather than noise. */
+    static constexpr double kReinitFraction = 0.25;
+
+    void Init(int64_t sample_ns);
+
+    double nominal_period_;
+    double r_;       /**< Measurement noise variance. */
+    double q_phase_; /**< Phase process noise variance. */
+    double q_period_; /**< Period process noise variance. */
+
+    bool initialized_;
+    int64_t origin_; /**< Absolute time of the last measurement. */
+    double phase_;   /**< Estimated edge time relative to origin_. */
+    double period_;  /**< Estimated period. */
+    double p00_;     /**< Covariance matrix entries. */
+    double p01_;
+    double p11_;
+    uint64_t reinits_;
+};
+
+/**
+ * Estimator policy that passes every peer sample straight through. Stands in
+ * for PeerEstimator when estimation is disabled.
+ */
+class NullEstimator {
+   public:
+    /** Return \p peer_wakeup unchanged. */
+    timespec Update(const timespec& peer_wakeup) { return peer_wakeup; }
+
+    /** Does nothing. */
+    void Reset() {}
+};
+
+}  // namespace gsync
+
+#endif
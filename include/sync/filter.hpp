@@ -0,0 +1,209 @@
+#ifndef FILTER_H_
+#define FILTER_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+namespace gsync {
+
+/**
+ * Window of the last few peer phase errors.
+ *
+ * The outlier filters keep their samples in a fixed size ring. All storage is
+ * inline, the per sample cost is bounded by kMaxWindow.
+ */
+class PhaseErrorWindow {
+   public:
+    static const std::size_t kMaxWindow = 15; /**< Largest window size. */
+
+    /**
+     * Construct an empty window.
+     *
+     * @param[in] window Number of samples kept, in the range [1, kMaxWindow].
+     *
+     * @throws std::runtime_error
+     */
+    explicit PhaseErrorWindow(std::size_t window);
+
+    /* The default copy/move constructors and assignment methods will work for
+     * objects of this class. */
+    PhaseErrorWindow() = delete;
+    ~PhaseErrorWindow() = default;
+    PhaseErrorWindow(const PhaseErrorWindow&) = default;
+    PhaseErrorWindow& operator=(const PhaseErrorWindow&) = default;
+    PhaseErrorWindow(PhaseErrorWindow&&) = default;
+    PhaseErrorWindow& operator=(PhaseErrorWindow&&) = default;
+
+    /** Add a sample, dropping the oldest one if the window is full. */
+    void Push(int64_t phase_err);
+
+    /** Return the median of the window. The window must not be empty. */
+    int64_t Median() const;
+
+    /**
+     * Return the median absolute deviation of the window from \p median. The
+     * window must not be empty.
+     */
+    int64_t MedianAbsDeviation(int64_t median) const;
+
+    /** Return the number of samples in the window. */
+    std::size_t Count() const { return count_; }
+
+    /** Empty the window. */
+    void Reset() {
+        head_ = 0;
+        count_ = 0;
+    }
+
+   private:
+    std::size_t window_;
+    std::array<int64_t, kMaxWindow> ring_;
+    std::size_t head_;
+    std::size_t count_;
+};
+
+/**
+ * Filter policy that replaces each peer phase error with the median of the
+ * last few.
+ *
+ * MedianFilter sits between the shared memory read and the sync controller.
+ * A single delayed gtimer wakeup or glitch edge no longer kicks our schedule
+ * off for several cycles. No sample is ever rejected, so unlike MadFilter
+ * it has no rejection count.
+ */
+class MedianFilter {
+   public:
+    /**
+     * Construct a median filter.
+     *
+     * @param[in] window Number of samples considered, in the range
+     * [1, PhaseErrorWindow::kMaxWindow].
+     *
+     * @throws std::runtime_error
+     */
+    explicit MedianFilter(std::size_t window);
+
+    /* The default copy/move constructors and assignment methods will work for
+     * objects of this class. */
+    MedianFilter() = delete;
+    ~MedianFilter() = default;
+    MedianFilter(const MedianFilter&) = default;
+    MedianFilter& operator=(const MedianFilter&) = default;
+    MedianFilter(MedianFilter&&) = default;
+    MedianFilter& operator=(MedianFilter&&) = default;
+
+    /**
+     * Filter a phase error sample.
+     *
+     * @param[in] phase_err Phase error in nanoseconds.
+     *
+     * @returns The median of the window, \p phase_err included.
+     */
+    std::optional<int64_t> Filter(int64_t phase_err);
+
+    /** Empty the window. Counters are preserved. */
+    void Reset() { window_.Reset(); }
+
+    /** Return the number of accepted samples. */
+    uint64_t Accepted() const { return accepted_; }
+
+   private:
+    PhaseErrorWindow window_;
+    uint64_t accepted_;
+};
+
+/**
+ * Filter policy that rejects peer phase errors too far outside of the last
+ * few.
+ *
+ * MadFilter gates samples that fall further than a number of standard
+ * deviations, as estimated by the median absolute deviation (MAD), from the
+ * window's median. Rejected samples are still added to the window so that a
+ * genuine step in the peer's phase is accepted once it makes up the majority
+ * of the window.
+ */
+class MadFilter {
+   public:
+    /**
+     * Construct a MAD filter.
+     *
+     * @param[in] window Number of samples considered, in the range
+     * [1, PhaseErrorWindow::kMaxWindow].
+     * @param[in] mad_threshold MAD gate width in standard deviations.
+     *
+     * @throws std::runtime_error
+     */
+    MadFilter(std::size_t window, double mad_threshold);
+
+    /* The default copy/move constructors and assignment methods will work for
+     * objects of this class. */
+    MadFilter() = delete;
+    ~MadFilter() = default;
+    MadFilter(const MadFilter&) = default;
+    MadFilter& operator=(const MadFilter&) = default;
+    MadFilter(MadFilter&&) = default;
+    MadFilter& operator=(MadFilter&&) = default;
+
+    /**
+     * Filter a phase error sample.
+     *
+     * @param[in] phase_err Phase error in nanoseconds.
+     *
+     * @returns \p phase_err or \a std::nullopt if the sample was rejected.
+     */
+    std::optional<int64_t> Filter(int64_t phase_err);
+
+    /** Empty the window. Counters are preserved. */
+    void Reset() { window_.Reset(); }
+
+    /** Return the number of accepted samples. */
+    uint64_t Accepted() const { return accepted_; }
+
+    /** Return the number of rejected samples. */
+    uint64_t Rejected() const { return rejected_; }
+
+   private:
+    /** Scale factor that makes the MAD a consistent estimator of the standard
+     * deviation for normally distributed samples. */
+    static constexpr double kMadToSigma = 1.4826;
+
+    /** Lower bound on the MAD so that an ideal, jitter free window doesn't
+     * reject every sample that isn't bit-for-bit identical. */
+    static constexpr int64_t kMinMadNano = 1000;
+
+    /** Samples needed before the MAD gate is applied. */
+    static const std::size_t kMinMadSamples = 3;
+
+    PhaseErrorWindow window_;
+    double mad_threshold_;
+    uint64_t accepted_;
+    uint64_t rejected_;
+};
+
+/**
+ * Filter policy that accepts every phase error sample, used when no outlier
+ * filter is selected.
+ */
+class NullFilter {
+   public:
+    /** Accept \p phase_err unchanged. */
+    std::optional<int64_t> Filter(int64_t phase_err) {
+        accepted_++;
+        return phase_err;
+    }
+
+    /** Does nothing. */
+    void Reset() {}
+
+    /** Return the number of accepted samples. */
+    uint64_t Accepted() const { return accepted_; }
+
+   private:
+    uint64_t accepted_ = 0;
+};
+
+}  // namespace gsync
+
+#endif
@@ -0,0 +1,103 @@
+#ifndef FIXED_SYNC_H_
+#define FIXED_SYNC_H_
+
+#include <time.h>
+
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+
+#include "sync/phase.hpp"
+#include "sync/sync.hpp"
+
+namespace gsync {
+
+/**
+ * First-order Kuramoto controller specialized for a fixed period.
+ *
+ * FixedKuramotoSync implements the same control law as KuramotoSync but takes
+ * its period as a template parameter. All of the nanosecond/radian conversion
+ * constants and the natural frequency are folded at compile time, and the
+ * phase difference is computed in integer nanoseconds before it is converted
+ * to radians. Each instantiation carries its own constants so any number of
+ * channels at different rates can run in one process.
+ *
+ * @tparam PeriodNs Sync period in nanoseconds.
+ */
+template <int64_t PeriodNs>
+class FixedKuramotoSync final : public SyncController {
+    static_assert(PeriodNs > 0, "period must be greater than 0");
+
+   public:
+    /**
+     * Construct a fixed period Kuramoto sync object.
+     *
+     * @param[in] coupling_constant The coupling constant, K, in the Kuramoto
+     * Model.
+     *
+     * @throws std::runtime_error
+     */
+    explicit FixedKuramotoSync(double coupling_constant)
+        : SyncController(SyncRate::FromPeriodNs(PeriodNs)),
+          coupling_per_participant_(
+              coupling_constant /
+              static_cast<double>(KuramotoSync::kNumParticipants)) {
+        if (coupling_constant <= 0.0) {
+            throw std::runtime_error(
+                "coupling constant must be greater than 0");
+        }
+    }
+
+    /* The default copy/move constructors and assignment methods will work for
+     * objects of this class. */
+    FixedKuramotoSync() = delete;
+    ~FixedKuramotoSync() = default;
+    FixedKuramotoSync(const FixedKuramotoSync&) = default;
+    FixedKuramotoSync& operator=(const FixedKuramotoSync&) = default;
+    FixedKuramotoSync(FixedKuramotoSync&&) = default;
+    FixedKuramotoSync& operator=(FixedKuramotoSync&&) = default;
+
+    /** Return the sync period in nanoseconds. */
+    static constexpr int64_t Period() { return PeriodNs; }
+
+    /** Return the coupling constant. */
+    double CouplingConstant() const {
+        return coupling_per_participant_ *
+               static_cast<double>(KuramotoSync::kNumParticipants);
+    }
+
+    /**
+     * Run the Kuramoto algorithm to compute this participant's new wakeup time.
+     *
+     * @param[in] actual_wakeup The time when this participant actually wokeup
+     * to begin its current cycle.
+     * @param[in] peer_wakeup The last wakeup time reported by this
+     * participant's peer.
+     *
+     * @returns The new wakeup time for this participant which would bring him
+     * closer to or keep him in sync with his peer.
+     */
+    timespec ComputeNewWakeup(const timespec& actual_wakeup,
+                              const timespec& peer_wakeup) override {
+        int64_t actual_ns = TsToNano(actual_wakeup);
+        double dtheta = kRadPerNano * static_cast<double>(
+                                          TsToNano(peer_wakeup) - actual_ns);
+        double correction = coupling_per_participant_ * std::sin(dtheta);
+
+        return NanoToTs(actual_ns + PeriodNs +
+                        static_cast<int64_t>(kNanoPerRad * correction));
+    }
+
+   private:
+    static constexpr double kPi = 3.141592653589793;
+    static constexpr double kRadPerNano =
+        (2 * kPi) / static_cast<double>(PeriodNs);
+    static constexpr double kNanoPerRad =
+        static_cast<double>(PeriodNs) / (2 * kPi);
+
+    double coupling_per_participant_;
+};
+
+}  // namespace gsync
+
+#endif
@@ -0,0 +1,395 @@
+#ifndef LOOP_H_
+#define LOOP_H_
+
+#include <time.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <optional>
+
+#include "sync/phase.hpp"
+#include "sync/policy.hpp"
+#include "util/usdt/usdt.hpp"
+
+namespace gsync {
+
+/** Event loop counters. */
+struct LoopTelemetry {
+    uint64_t cycles = 0;           /**< Total cycles run. */
+    uint64_t base_rate_cycles = 0; /**< Cycles scheduled at the base rate. */
+    uint64_t tracked_cycles = 0;   /**< Cycles scheduled by the controller. */
+    uint64_t phase_steps = 0;      /**< Acquisition phase steps taken. */
+    uint64_t io_errors = 0;        /**< Failed line writes and peer reads. */
+};
+
+/** Event loop parameters. */
+struct LoopConfig {
+    double max_step = 0.5;  /**< Largest acquisition phase step in periods. */
+    int64_t latency_ns = 0; /**< One-way capture latency taken off of every
+                               peer sample. */
+};
+
+/** Sync state machine. See SyncLoop::Cycle() for the transitions. */
+enum class SyncState {
+    kFreeRun, /**< No peer samples, run at the base rate. */
+    kAcquire, /**< Have peer samples, waiting to step onto the peer's phase. */
+    kTrack,   /**< Locked onto the peer's phase, controller fine tunes. */
+};
+
+/**
+ * The gsync event loop.
+ *
+ * Each cycle raises our wakeup edge, reads the peer's last reported wakeup,
+ * runs the acquire/track state machine and schedules the next wakeup.
+ * SyncLoop is composed of compile time policies (see policy.hpp). Given
+ * concrete policies, a cycle makes no virtual calls and checks no mode flags:
+ * each outlier filter, overrun recovery and controller variant is its own
+ * type, and a disabled estimator or filter is a NullEstimator or NullFilter
+ * that compiles away. The same loop runs against CLOCK_MONOTONIC in gsync and
+ * against a VirtualClock in benchmarks, where it runs millions of cycles a
+ * second and yields the same schedule on every run.
+ *
+ * Every decision the loop makes fires a USDT probe (see usdt.hpp) carrying
+ * the timestamps it was made on: peer_read, phase_step, base_rate,
+ * compute_wakeup, sleep_enter and sleep_exit. Timestamps are in nanoseconds
+ * on the loop's clock.
+ *
+ * Each section of a cycle is wrapped in the Probe policy and in the loop's
+ * own span timers, LoopSpans. The Probe policy is also told when each cycle
+ * woke up, right after the wakeup is read, and when the loop goes to sleep.
+ * The span timers are compiled in or out as a whole by the GSYNC_SPAN_TIMERS
+ * build option. They time either the whole pulse or its parts, never both,
+ * see IsTimedSpan().
+ *
+ * Line and channel failures don't stop the loop. They are counted in
+ * LoopTelemetry::io_errors and a failed peer read is treated like a cycle
+ * without a fresh sample, so a loop that loses its I/O degrades to free
+ * running.
+ *
+ * The caller drives the loop. Cycle() does the work of one cycle and Sleep()
+ * waits for the next one, leaving room in between for housekeeping that isn't
+ * part of the loop proper.
+ *
+ * @tparam Clock Clock policy.
+ * @tparam Line Line our wakeup edges are sent on.
+ * @tparam Channel Channel the peer's wakeups are read from.
+ * @tparam Controller Wakeup controller.
+ * @tparam Estimator Peer wakeup estimator.
+ * @tparam Filter Phase error outlier filter.
+ * @tparam Overrun Wakeup overrun policy.
+ * @tparam Probe Section probe, NullProbe unless the loop is instrumented.
+ */
+template <ClockPolicy Clock, LinePolicy Line, PeerChannelPolicy Channel,
+          ControllerPolicy Controller, EstimatorPolicy Estimator,
+          FilterPolicy Filter, OverrunPolicy Overrun, ProbePolicy Probe>
+class SyncLoop {
+   public:
+    /**
+     * Construct an event loop. SyncLoop keeps references to all of its
+     * collaborators, they must outlive it.
+     *
+     * @param[in] clock Clock.
+     * @param[in] sync Wakeup controller.
+     * @param[in] estimator Peer wakeup estimator.
+     * @param[in] filter Phase error outlier filter.
+     * @param[in] overrun Wakeup overrun policy.
+     * @param[in] config Loop parameters.
+     * @param[in] line Line our wakeup edges are sent on.
+     * @param[in] peer Channel the peer's last reported wakeup is read from.
+     * @param[in] probe Probe wrapped around each LoopSection.
+     */
+    SyncLoop(Clock& clock, Controller& sync, Estimator& estimator,
+             Filter& filter, Overrun& overrun, const LoopConfig& config,
+             Line& line, Channel& peer, Probe& probe);
+
+    /* No reason to copy or move SyncLoop objects at this time. */
+    SyncLoop() = delete;
+    ~SyncLoop() = default;
+    SyncLoop(const SyncLoop&) = delete;
+    SyncLoop& operator=(const SyncLoop&) = delete;
+    SyncLoop(SyncLoop&&) = delete;
+    SyncLoop& operator=(SyncLoop&&) = delete;
+
+    /** Run one cycle, from raising our wakeup edge to lowering it. */
+    void Cycle();
+
+    /** Sleep until the wakeup scheduled by the last Cycle(). */
+    void Sleep();
+
+    /** Run one cycle then sleep until the next one. */
+    void Step() {
+        Cycle();
+        Sleep();
+    }
+
+    /** Return the loop counters. */
+    const LoopTelemetry& Telemetry() const { return telemetry_; }
+
+    /** Return the sync state. */
+    SyncState State() const { return state_; }
+
+    /** Return the time the last cycle actually woke up. */
+    timespec LastWakeup() const { return actual_wakeup_; }
+
+    /** Return the wakeup scheduled by the last cycle. */
+    timespec NextWakeup() const { return new_wakeup_; }
+
+    /** Return the span timers. */
+    const LoopSpans& Spans() const { return spans_; }
+
+   private:
+    /* Consecutive cycles without a fresh peer sample after which we consider
+     * our peer gone and fall back to free running. A cycle or two can come up
+     * empty while tracking just because the peer's edge straddles our
+     * wakeup. */
+    static constexpr int kMaxMissedCycles = 3;
+
+    static bool TsEqual(const timespec& a, const timespec& b) {
+        return ((a.tv_sec == b.tv_sec) && (a.tv_nsec == b.tv_nsec));
+    }
+
+    /* Mark a section for the probe and the span timers. The span timers
+     * nest inside the probe so that they don't time the probe's reads. Every
+     * call passes a constant section, so the IsTimedSpan() check folds
+     * away. */
+    void Begin(LoopSection section) {
+        probe_.Begin(section);
+        if (IsTimedSpan(section)) {
+            spans_.Begin(section);
+        }
+    }
+    void End(LoopSection section) {
+        if (IsTimedSpan(section)) {
+            spans_.End(section);
+        }
+        probe_.End(section);
+    }
+
+    Clock& clock_;
+    Controller& sync_;
+    Estimator& estimator_;
+    Filter& filter_;
+    Overrun& overrun_;
+    Line& line_;
+    Channel& peer_;
+    Probe& probe_;
+    LoopSpans spans_;
+
+    int64_t period_ns_;
+    int64_t max_step_ns_;
+    int64_t reacquire_ns_;
+    int64_t latency_ns_;
+
+    timespec actual_wakeup_;
+    timespec new_wakeup_;
+    timespec sleep_until_;
+    timespec prev_peer_wakeup_;
+    SyncState state_;
+    int missed_cycles_;
+    LoopTelemetry telemetry_;
+};
+
+/**
+ * Check whether a peer sample can be trusted.
+ *
+ * A peer sample is trusted if it landed a whole number of periods after the
+ * previous sample, give or take a tenth of a period. This weeds out the
+ * partial period between the peer starting and its schedule settling as well
+ * as glitch edges.
+ *
+ * @param[in] peer_wakeup The peer's latest wakeup.
+ * @param[in] prev_peer_wakeup The peer's previous wakeup.
+ * @param[in] period_ns Nominal sync period in nanoseconds.
+ */
+bool IsTrustedSample(const timespec& peer_wakeup,
+                     const timespec& prev_peer_wakeup, int64_t period_ns);
+
+template <ClockPolicy Clock, LinePolicy Line, PeerChannelPolicy Channel,
+          ControllerPolicy Controller, EstimatorPolicy Estimator,
+          FilterPolicy Filter, OverrunPolicy Overrun, ProbePolicy Probe>
+SyncLoop<Clock, Line, Channel, Controller, Estimator, Filter, Overrun,
+         Probe>::SyncLoop(Clock& clock, Controller& sync, Estimator& estimator,
+                          Filter& filter, Overrun& overrun,
+                          const LoopConfig& config, Line& line, Channel& peer,
+                          Probe& probe)
+    : clock_(clock),
+      sync_(sync),
+      estimator_(estimator),
+      filter_(filter),
+      overrun_(overrun),
+      line_(line),
+      peer_(peer),
+      probe_(probe),
+      spans_(),
+      period_ns_(sync.Rate().NominalPeriod()),
+      /* Phase steps are bounded to max_step periods. A tracked peer whose
+       * phase error exceeds a quarter period has jumped and must be
+       * reacquired. */
+      max_step_ns_(static_cast<int64_t>(config.max_step *
+                                        static_cast<double>(period_ns_))),
+      reacquire_ns_(period_ns_ / 4),
+      latency_ns_(config.latency_ns),
+      actual_wakeup_{},
+      new_wakeup_{},
+      sleep_until_{},
+      prev_peer_wakeup_{},
+      state_(SyncState::kFreeRun),
+      missed_cycles_(0),
+      telemetry_() {}
+
+template <ClockPolicy Clock, LinePolicy Line, PeerChannelPolicy Channel,
+          ControllerPolicy Controller, EstimatorPolicy Estimator,
+          FilterPolicy Filter, OverrunPolicy Overrun, ProbePolicy Probe>
+void SyncLoop<Clock, Line, Channel, Controller, Estimator, Filter, Overrun,
+              Probe>::Cycle() {
+    const timespec kEmptyTs = {.tv_sec = 0, .tv_nsec = 0};
+
+    /* Send wakeup signal to our peer. */
+    Begin(LoopSection::kPulse);
+    Begin(LoopSection::kLineRaise);
+    Expected<void> raised = line_.SetValue(1);
+    End(LoopSection::kLineRaise);
+    if (!raised) {
+        telemetry_.io_errors++;
+    }
+
+    /* Record our true wakeup time. */
+    Begin(LoopSection::kTimestamp);
+    actual_wakeup_ = clock_.Now();
+    End(LoopSection::kTimestamp);
+    probe_.Wake(telemetry_.cycles + 1, actual_wakeup_, sleep_until_);
+
+    /* Record our peer's last reported wakeup time. A failed read looks like
+     * a stale sample. */
+    Begin(LoopSection::kPeerRead);
+    Expected<timespec> peer_read = peer_.Read();
+    End(LoopSection::kPeerRead);
+    if (!peer_read) {
+        telemetry_.io_errors++;
+    }
+    timespec peer_wakeup = (peer_read) ? peer_read.Value() : prev_peer_wakeup_;
+
+    bool is_fresh = !TsEqual(kEmptyTs, peer_wakeup) &&
+                    !TsEqual(prev_peer_wakeup_, peer_wakeup);
+    GSYNC_PROBE3(peer_read, TsToNano(actual_wakeup_), TsToNano(peer_wakeup),
+                 static_cast<int>(is_fresh));
+    missed_cycles_ = (is_fresh) ? 0 : (missed_cycles_ + 1);
+    if (missed_cycles_ >= kMaxMissedCycles) {
+        state_ = SyncState::kFreeRun;
+    }
+
+    bool is_trusted = is_fresh && IsTrustedSample(peer_wakeup,
+                                                  prev_peer_wakeup_,
+                                                  period_ns_);
+    /* gtimer captures the peer's edge some time after the peer actually woke
+     * up. Take the calibrated one-way latency off of the sample. */
+    int64_t phase_err = PhaseErrorNano(
+        actual_wakeup_, NanoToTs(TsToNano(peer_wakeup) - latency_ns_),
+        period_ns_);
+    if ((state_ == SyncState::kTrack) && is_trusted &&
+        (std::abs(phase_err) > reacquire_ns_)) {
+        /* The peer's phase jumped, e.g., it restarted before we noticed it
+         * was gone. */
+        state_ = SyncState::kAcquire;
+    }
+
+    /* Jump straight onto the peer's phase rather than letting the controller
+     * slowly pull us in. Only the participant that leads steps (by delaying
+     * itself) so that two participants acquiring each other at the same time
+     * don't just swap phases. Delaying also guarantees we never emit a short
+     * period. The participant that lags waits for the leader's step unless the
+     * gap is already small enough to leave to the controller. */
+    bool stepped = false;
+    if (is_fresh && (state_ != SyncState::kTrack)) {
+        if ((state_ == SyncState::kAcquire) && is_trusted &&
+            (phase_err >= 0)) {
+            new_wakeup_ =
+                NanoToTs(TsToNano(sync_.NominalWakeup(actual_wakeup_)) +
+                         std::min(phase_err, max_step_ns_));
+            estimator_.Reset();
+            filter_.Reset();
+            if (phase_err <= max_step_ns_) {
+                state_ = SyncState::kTrack;
+            }
+            stepped = true;
+            telemetry_.phase_steps++;
+            GSYNC_PROBE3(phase_step, TsToNano(actual_wakeup_),
+                         TsToNano(new_wakeup_), phase_err);
+        } else if ((state_ == SyncState::kAcquire) && is_trusted &&
+                   (phase_err >= -reacquire_ns_)) {
+            state_ = SyncState::kTrack;
+        } else {
+            state_ = SyncState::kAcquire;
+        }
+    }
+
+    /* Run the phase error through the outlier filter before the controller
+     * ever sees it. A rejected sample is treated like a missing one. */
+    std::optional<int64_t> filtered_err;
+    if (is_fresh && !stepped && (state_ == SyncState::kTrack)) {
+        filtered_err = filter_.Filter(phase_err);
+    }
+
+    if (stepped) {
+        /* Wakeup already scheduled by the phase step. */
+    } else if (!filtered_err) {
+        /* Our peer is offline, not reporting for some other reason, not yet
+         * acquired, or sent us an outlier. Schedule wakeup using the base
+         * rate. The period is added to the previously scheduled wakeup rather
+         * than the actual one so that wakeup latency doesn't accumulate into
+         * the free running schedule. */
+        new_wakeup_ = sync_.NominalWakeup(
+            TsEqual(kEmptyTs, new_wakeup_) ? actual_wakeup_ : new_wakeup_);
+        telemetry_.base_rate_cycles++;
+        GSYNC_PROBE2(base_rate, TsToNano(actual_wakeup_),
+                     TsToNano(new_wakeup_));
+    } else {
+        /* Compute a new wakeup time that will keep us in sync with our peer.
+         * If enabled, correct against the filtered estimate of the peer's
+         * wakeup rather than the raw, jittery sample. */
+        timespec peer_sample =
+            NanoToTs(TsToNano(actual_wakeup_) + *filtered_err);
+        timespec peer_estimate = estimator_.Update(peer_sample);
+        Begin(LoopSection::kCompute);
+        new_wakeup_ = sync_.ComputeNewWakeup(actual_wakeup_, peer_estimate);
+        End(LoopSection::kCompute);
+        telemetry_.tracked_cycles++;
+        GSYNC_PROBE3(compute_wakeup, TsToNano(actual_wakeup_),
+                     TsToNano(peer_estimate), TsToNano(new_wakeup_));
+    }
+    prev_peer_wakeup_ = peer_wakeup;
+    telemetry_.cycles++;
+
+    /* Bring down the GPIO line as we wrap up this run. */
+    Begin(LoopSection::kLineLower);
+    Expected<void> lowered = line_.SetValue(0);
+    End(LoopSection::kLineLower);
+    End(LoopSection::kPulse);
+    if (!lowered) {
+        telemetry_.io_errors++;
+    }
+}
+
+template <ClockPolicy Clock, LinePolicy Line, PeerChannelPolicy Channel,
+          ControllerPolicy Controller, EstimatorPolicy Estimator,
+          FilterPolicy Filter, OverrunPolicy Overrun, ProbePolicy Probe>
+void SyncLoop<Clock, Line, Channel, Controller, Estimator, Filter, Overrun,
+              Probe>::Sleep() {
+    /* A wakeup that is already in the past would return immediately and fire
+     * a burst of edges at our peer. Let the overrun policy decide when we
+     * actually wake up. */
+    sleep_until_ = overrun_.Apply(new_wakeup_, clock_.Now(), period_ns_);
+
+    /* Sleep until our next cycle. */
+    probe_.Sleep(telemetry_.cycles, sleep_until_);
+    GSYNC_PROBE2(sleep_enter, TsToNano(new_wakeup_), TsToNano(sleep_until_));
+    Begin(LoopSection::kSleep);
+    clock_.SleepUntil(sleep_until_);
+    End(LoopSection::kSleep);
+    GSYNC_PROBE1(sleep_exit, TsToNano(sleep_until_));
+}
+
+}  // namespace gsync
+
+#endif
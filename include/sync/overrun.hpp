@@ -0,0 +1,124 @@
+#ifndef OVERRUN_H_
+#define OVERRUN_H_
+
+#include <time.h>
+
+#include <cstdint>
+
+namespace gsync {
+
+/*
+ * Wakeup overrun policies for SyncLoop, see OverrunPolicy in policy.hpp.
+ *
+ * If a wakeup is already in the past when we go to sleep (e.g., after a long
+ * stall), clock_nanosleep() returns immediately. Left alone, a schedule that
+ * is several periods behind fires a burst of back-to-back edges which floods
+ * the peer's gtimer. Each policy detects such overruns and applies its own
+ * recovery. Apply() takes the scheduled wakeup, updates it if the policy
+ * moves the schedule, and returns the time to actually sleep until.
+ */
+
+/** Overrun policy that drops the missed periods and sleeps until the next
+ * period boundary of the schedule. */
+class SkipOverrun {
+   public:
+    /**
+     * Check a wakeup for an overrun and skip the missed periods.
+     *
+     * @param[in,out] wakeup The scheduled wakeup. Moved forward by whole
+     * periods on an overrun.
+     * @param[in] now The current time.
+     * @param[in] period_ns Nominal period in nanoseconds.
+     *
+     * @returns The time to actually sleep until.
+     */
+    timespec Apply(timespec& wakeup, const timespec& now, int64_t period_ns);
+
+    /** Return the number of overruns detected. */
+    uint64_t Overruns() const { return overruns_; }
+
+    /** Return the number of whole periods dropped. */
+    uint64_t SkippedPeriods() const { return skipped_periods_; }
+
+   private:
+    uint64_t overruns_ = 0;
+    uint64_t skipped_periods_ = 0;
+};
+
+/** Overrun policy that fires once right away and restarts the schedule from
+ * there. */
+class FireOnceOverrun {
+   public:
+    /**
+     * Check a wakeup for an overrun and restart the schedule from \p now.
+     *
+     * @param[in,out] wakeup The scheduled wakeup. Set to \p now on an
+     * overrun.
+     * @param[in] now The current time.
+     * @param[in] period_ns Nominal period in nanoseconds.
+     *
+     * @returns The time to actually sleep until.
+     */
+    timespec Apply(timespec& wakeup, const timespec& now, int64_t period_ns);
+
+    /** Return the number of overruns detected. */
+    uint64_t Overruns() const { return overruns_; }
+
+    /** Return the number of whole periods dropped, always 0. */
+    uint64_t SkippedPeriods() const { return 0; }
+
+   private:
+    uint64_t overruns_ = 0;
+};
+
+/** Overrun policy that keeps the schedule but shortens each period by at
+ * most a fixed fraction until we have caught up. */
+class CompressOverrun {
+   public:
+    /**
+     * Construct a compressing overrun policy.
+     *
+     * @param[in] max_compression The largest fraction by which a period may be
+     * shortened, in the range (0, 1). Also applies outside of overruns so
+     * that no two wakeups are ever closer than (1 - max_compression)
+     * periods.
+     *
+     * @throws std::runtime_error
+     */
+    explicit CompressOverrun(double max_compression);
+
+    /* The default copy/move constructors and assignment methods will work for
+     * objects of this class. */
+    CompressOverrun() = delete;
+    ~CompressOverrun() = default;
+    CompressOverrun(const CompressOverrun&) = default;
+    CompressOverrun& operator=(const CompressOverrun&) = default;
+    CompressOverrun(CompressOverrun&&) = default;
+    CompressOverrun& operator=(CompressOverrun&&) = default;
+
+    /**
+     * Check a wakeup for an overrun and pace the wakeup.
+     *
+     * @param[in] wakeup The scheduled wakeup. Never moved.
+     * @param[in] now The current time.
+     * @param[in] period_ns Nominal period in nanoseconds.
+     *
+     * @returns The time to actually sleep until.
+     */
+    timespec Apply(timespec& wakeup, const timespec& now, int64_t period_ns);
+
+    /** Return the number of overruns detected. */
+    uint64_t Overruns() const { return overruns_; }
+
+    /** Return the number of whole periods dropped, always 0. */
+    uint64_t SkippedPeriods() const { return 0; }
+
+   private:
+    double max_compression_;
+    int64_t last_target_ns_; /**< Last sleep target, 0 if none yet. */
+    uint64_t overruns_;
+};
+
+}  // namespace gsync
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef PHASE_H_
+#define PHASE_H_
+
+#include <time.h>
+
+#include <cstdint>
+
+namespace gsync {
+
+static const int64_t kNanoPerSec = 1000000000; /**< Nanoseconds per second. */
+
+/** Convert a timespec to an integer count of nanoseconds. */
+int64_t TsToNano(const timespec& ts);
+
+/** Convert an integer count of nanoseconds to a normalized timespec. */
+timespec NanoToTs(int64_t ns);
+
+/**
+ * Compute the phase error between this participant and its peer.
+ *
+ * The raw difference \a peer - \a actual is wrapped into the interval
+ * [-period_ns / 2, period_ns / 2) so that an edge which arrives just before
+ * the end of our period is treated as a peer that leads us rather than one
+ * that lags us by almost a full period.
+ *
+ * @param[in] actual Time at which this participant woke up.
+ * @param[in] peer Time at which the peer's last wakeup edge was captured.
+ * @param[in] period_ns Nominal sync period in nanoseconds.
+ *
+ * @returns The wrapped phase error in nanoseconds. A positive value means the
+ * peer lags us.
+ */
+int64_t PhaseErrorNano(const timespec& actual, const timespec& peer,
+                       int64_t period_ns);
+
+}  // namespace gsync
+
+#endif
@@ -0,0 +1,81 @@
+#ifndef PLL_H_
+#define PLL_H_
+
+#include <time.h>
+
+#include <cstdint>
+
+#include "sync/sync.hpp"
+
+namespace gsync {
+
+/**
+ * Second-order (proportional-integral) phase locked loop controller.
+ *
+ * PllSync measures the wrapped phase error between this participant and its
+ * peer each cycle. The proportional term pulls the phases together while the
+ * integral term accumulates an estimate of the frequency offset between the
+ * two oscillators. Unlike KuramotoSync, this drives the steady-state phase
+ * error to zero in the presence of constant crystal drift.
+ */
+class PllSync final : public SyncController {
+   public:
+    /**
+     * Construct a PLL sync object with the specified rate and loop gains.
+     *
+     * @param[in] rate Rate at which this task runs.
+     * @param[in] kp Proportional gain. The fraction of the phase error that
+     * is corrected each cycle.
+     * @param[in] ki Integral gain. The fraction of the phase error that is
+     * folded into the frequency correction each cycle.
+     *
+     * @throws std::runtime_error
+     */
+    PllSync(const SyncRate& rate, double kp, double ki);
+
+    /* The default copy/move constructors and assignment methods will work for
+     * objects of this class. */
+    PllSync() = delete;
+    ~PllSync() = default;
+    PllSync(const PllSync&) = default;
+    PllSync& operator=(const PllSync&) = default;
+    PllSync(PllSync&&) = default;
+    PllSync& operator=(PllSync&&) = default;
+
+    /** Return the proportional gain. */
+    double Kp() const { return kp_; }
+
+    /** Return the integral gain. */
+    double Ki() const { return ki_; }
+
+    /** Return the current frequency correction in nanoseconds per cycle. */
+    double FrequencyCorrection() const { return integrator_; }
+
+    /**
+     * Run the PI control law to compute this participant's new wakeup time.
+     *
+     * @param[in] actual_wakeup The time when this participant actually wokeup
+     * to begin its current cycle.
+     * @param[in] peer_wakeup The last wakeup time reported by this
+     * participant's peer.
+     *
+     * @returns The new wakeup time for this participant.
+     */
+    timespec ComputeNewWakeup(const timespec& actual_wakeup,
+                              const timespec& peer_wakeup) override;
+
+   private:
+    /** Bound on the integrator as a fraction of the period. Real oscillators
+     * are off by tens of ppm, anything larger is windup. */
+    static constexpr double kMaxCorrectionFraction = 0.01;
+
+    int64_t period_ns_; /**< Nominal period, used to wrap the phase error. */
+    double kp_;
+    double ki_;
+    double integrator_;
+    double integrator_limit_;
+};
+
+}  // namespace gsync
+
+#endif
@@ -0,0 +1,115 @@
+#ifndef POLICY_H_
+#define POLICY_H_
+
+#include <time.h>
+
+#include <concepts>
+#include <cstdint>
+#include <optional>
+
+#include "sync/probe.hpp"
+#include "sync/rate.hpp"
+#include "util/expected/expected.hpp"
+
+namespace gsync {
+
+/*
+ * Policies SyncLoop and gtimer's event loop are composed of. gsync and gtimer
+ * resolve each policy to a concrete type once, at startup, so every deployed
+ * configuration compiles into a loop without virtual calls or mode checks.
+ * I/O policies report failure through an Expected rather than an exception so
+ * the loops can be built with -fno-exceptions.
+ */
+
+/**
+ * Clock policy. SleepUntil() blocks, or pretends to block, until \a wakeup on
+ * the clock's timeline. See clock.hpp.
+ */
+template <typename T>
+concept ClockPolicy = requires(T clock, const timespec& wakeup) {
+    { clock.Now() } -> std::same_as<timespec>;
+    clock.SleepUntil(wakeup);
+};
+
+/** Output line policy, e.g., a concrete GpioBackend or NullLine. */
+template <typename T>
+concept LinePolicy = requires(T line, int value) {
+    { line.SetValue(value) } -> std::same_as<Expected<void>>;
+};
+
+/** Edge input line policy, e.g., a concrete GpioBackend. */
+template <typename T>
+concept EdgeLinePolicy = requires(T line) {
+    { line.WaitForEdge() } -> std::same_as<Expected<timespec>>;
+};
+
+/** Peer channel policy, the read side of gtimer's timestamp slot. */
+template <typename T>
+concept PeerChannelPolicy = requires(T channel) {
+    { channel.Read() } -> std::same_as<Expected<timespec>>;
+};
+
+/** Peer channel policy, the write side of gtimer's timestamp slot. */
+template <typename T>
+concept PublishChannelPolicy = requires(T channel, const timespec& ts) {
+    { channel.Publish(ts) } -> std::same_as<Expected<void>>;
+};
+
+/** Sync controller policy, e.g., a final SyncController subclass. */
+template <typename T>
+concept ControllerPolicy = requires(T sync, const timespec& ts) {
+    { sync.Rate() } -> std::convertible_to<const SyncRate&>;
+    { sync.NominalWakeup(ts) } -> std::same_as<timespec>;
+    { sync.ComputeNewWakeup(ts, ts) } -> std::same_as<timespec>;
+};
+
+/** Peer estimator policy, PeerEstimator or NullEstimator. */
+template <typename T>
+concept EstimatorPolicy = requires(T estimator, const timespec& ts) {
+    estimator.Reset();
+    { estimator.Update(ts) } -> std::same_as<timespec>;
+};
+
+/**
+ * Phase error filter policy, MedianFilter, MadFilter or NullFilter. Only
+ * filters that can reject a sample, e.g., MadFilter, count rejections with a
+ * Rejected() method.
+ */
+template <typename T>
+concept FilterPolicy = requires(T filter, int64_t phase_err) {
+    filter.Reset();
+    { filter.Filter(phase_err) } -> std::same_as<std::optional<int64_t>>;
+    { filter.Accepted() } -> std::convertible_to<uint64_t>;
+};
+
+/**
+ * Wakeup overrun policy, SkipOverrun, FireOnceOverrun or CompressOverrun. See
+ * overrun.hpp.
+ */
+template <typename T>
+concept OverrunPolicy =
+    requires(T overrun, timespec& wakeup, const timespec& now,
+             int64_t period_ns) {
+        { overrun.Apply(wakeup, now, period_ns) } -> std::same_as<timespec>;
+        { overrun.Overruns() } -> std::convertible_to<uint64_t>;
+        { overrun.SkippedPeriods() } -> std::convertible_to<uint64_t>;
+    };
+
+/**
+ * Section probe policy, e.g., PerfProbe, MarkerProbe or NullProbe. Begin()
+ * and End() bracket each LoopSection. Wake() is called with a cycle's wakeup
+ * time as soon as it is read and the time it was due, Sleep() with the time
+ * the loop is about to sleep until. See probe.hpp.
+ */
+template <typename T>
+concept ProbePolicy = requires(T probe, LoopSection section, uint64_t seq,
+                               const timespec& ts) {
+    probe.Begin(section);
+    probe.End(section);
+    probe.Wake(seq, ts, ts);
+    probe.Sleep(seq, ts);
+};
+
+}  // namespace gsync
+
+#endif
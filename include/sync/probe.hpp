@@ -0,0 +1,278 @@
+#ifndef PROBE_H_
+#define PROBE_H_
+
+#include <time.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "sync/clock.hpp"
+#include "sync/phase.hpp"
+#include "util/perf/histogram.hpp"
+#include "util/perf/sections.hpp"
+#include "util/trace/marker.hpp"
+
+namespace gsync {
+
+/* Probe policies for SyncLoop, see ProbePolicy in policy.hpp. */
+
+/** Instrumented sections of a SyncLoop cycle. */
+enum class LoopSection {
+    kPulse,     /**< The whole output pulse, raising to lowering our edge. */
+    kLineRaise, /**< Raising our wakeup edge. */
+    kTimestamp, /**< Reading the clock for our actual wakeup time. */
+    kPeerRead,  /**< Reading the peer's last reported wakeup. */
+    kCompute,   /**< The controller's ComputeNewWakeup(). */
+    kLineLower, /**< Lowering our wakeup edge. */
+    kSleep,     /**< Sleeping until the next wakeup. */
+};
+
+/** Number of LoopSection values. */
+static constexpr std::size_t kNumLoopSections = 7;
+
+/** Return a short name for \p section, e.g., "peer_read". */
+inline const char* LoopSectionName(LoopSection section) {
+    switch (section) {
+        case LoopSection::kPulse:
+            return "pulse";
+        case LoopSection::kLineRaise:
+            return "line_raise";
+        case LoopSection::kTimestamp:
+            return "timestamp";
+        case LoopSection::kPeerRead:
+            return "peer_read";
+        case LoopSection::kCompute:
+            return "compute";
+        case LoopSection::kLineLower:
+            return "line_lower";
+        case LoopSection::kSleep:
+            return "sleep";
+    }
+    return "unknown";
+}
+
+/** Probe policy that instruments nothing and compiles away. */
+class NullProbe {
+   public:
+    void Begin(LoopSection section) { (void)section; }
+    void End(LoopSection section) { (void)section; }
+    void Wake(uint64_t seq, const timespec& woke, const timespec& due) {
+        (void)seq;
+        (void)woke;
+        (void)due;
+    }
+    void Sleep(uint64_t seq, const timespec& until) {
+        (void)seq;
+        (void)until;
+    }
+};
+
+/** Probe policy that counts hardware events per section. */
+class PerfProbe {
+   public:
+    /**
+     * Construct a probe that accumulates into \p counters.
+     *
+     * @param[in] counters Section counters, must outlive the probe.
+     */
+    explicit PerfProbe(SectionCounters& counters) : counters_(&counters) {}
+
+    /* The default copy/move constructors and assignment methods will work for
+     * objects of this class. Copies share the counters. */
+    PerfProbe() = delete;
+    ~PerfProbe() = default;
+    PerfProbe(const PerfProbe&) = default;
+    PerfProbe& operator=(const PerfProbe&) = default;
+    PerfProbe(PerfProbe&&) = default;
+    PerfProbe& operator=(PerfProbe&&) = default;
+
+    void Begin(LoopSection section) {
+        counters_->Begin(static_cast<std::size_t>(section));
+    }
+    void End(LoopSection section) {
+        counters_->End(static_cast<std::size_t>(section));
+    }
+    void Wake(uint64_t seq, const timespec& woke, const timespec& due) {
+        (void)seq;
+        (void)woke;
+        (void)due;
+    }
+    void Sleep(uint64_t seq, const timespec& until) {
+        (void)seq;
+        (void)until;
+    }
+
+    /** Return the section counters. */
+    const SectionCounters& Counters() const { return *counters_; }
+
+   private:
+    SectionCounters* counters_;
+};
+
+static_assert(kNumLoopSections <= SectionCounters::kMaxSections);
+
+/**
+ * Probe policy that marks each wakeup and sleep in the ftrace buffer.
+ *
+ * Wake() is called right after the cycle reads its wakeup time, so the
+ * marker's trace timestamp is as close to the wakeup as the loop can get it.
+ * A wake marker carries the cycle's sequence number, its wakeup time and how
+ * late that was against the time the cycle before actually slept until. A
+ * sleep marker carries the sequence number of the cycle that just ran and the
+ * time it sleeps until, after the overrun policy had its say. The wake marker
+ * of cycle N pairs with the sleep marker of cycle N - 1. Sections aren't
+ * instrumented.
+ */
+class MarkerProbe {
+   public:
+    /**
+     * Construct a probe that writes to \p marker.
+     *
+     * @param[in] marker Trace marker, must outlive the probe.
+     */
+    explicit MarkerProbe(TraceMarker& marker) : marker_(&marker) {}
+
+    /* The default copy/move constructors and assignment methods will work for
+     * objects of this class. Copies share the marker. */
+    MarkerProbe() = delete;
+    ~MarkerProbe() = default;
+    MarkerProbe(const MarkerProbe&) = default;
+    MarkerProbe& operator=(const MarkerProbe&) = default;
+    MarkerProbe(MarkerProbe&&) = default;
+    MarkerProbe& operator=(MarkerProbe&&) = default;
+
+    void Begin(LoopSection section) { (void)section; }
+    void End(LoopSection section) { (void)section; }
+    void Wake(uint64_t seq, const timespec& woke, const timespec& due) {
+        int64_t woke_ns = TsToNano(woke);
+        int64_t due_ns = TsToNano(due);
+        (void)marker_->Mark(
+            "wake", {{"seq", static_cast<int64_t>(seq)},
+                     {"t_ns", woke_ns},
+                     {"late_ns", (due_ns) ? (woke_ns - due_ns) : 0}});
+    }
+    void Sleep(uint64_t seq, const timespec& until) {
+        (void)marker_->Mark("sleep", {{"seq", static_cast<int64_t>(seq)},
+                                      {"until_ns", TsToNano(until)}});
+    }
+
+    /** Return the trace marker. */
+    const TraceMarker& Marker() const { return *marker_; }
+
+   private:
+    TraceMarker* marker_;
+};
+
+/**
+ * Probe policy that times each section.
+ *
+ * Each pass through a section is timed and recorded in that section's
+ * LatencyHistogram. Sections are timed with the CPU's cycle counter where
+ * there is one, scaled to nanoseconds with a frequency measured once per
+ * process, otherwise with CLOCK_MONOTONIC. All storage is inline, Begin()
+ * and End() neither allocate nor throw.
+ */
+class SpanProbe {
+   public:
+    /**
+     * Construct a probe with empty histograms. The first probe constructed in
+     * a process measures the cycle counter frequency, which takes about
+     * 10 ms.
+     */
+    SpanProbe();
+
+    /* The default copy/move constructors and assignment methods will work for
+     * objects of this class. */
+    ~SpanProbe() = default;
+    SpanProbe(const SpanProbe&) = default;
+    SpanProbe& operator=(const SpanProbe&) = default;
+    SpanProbe(SpanProbe&&) = default;
+    SpanProbe& operator=(SpanProbe&&) = default;
+
+    void Begin(LoopSection section) noexcept {
+        start_[static_cast<std::size_t>(section)] = Ticks();
+    }
+    void End(LoopSection section) noexcept {
+        std::size_t i = static_cast<std::size_t>(section);
+        spans_[i].Add(static_cast<int64_t>(
+            static_cast<double>(Ticks() - start_[i]) * nanos_per_tick_));
+    }
+    void Wake(uint64_t seq, const timespec& woke,
+              const timespec& due) noexcept {
+        (void)seq;
+        (void)woke;
+        (void)due;
+    }
+    void Sleep(uint64_t seq, const timespec& until) noexcept {
+        (void)seq;
+        (void)until;
+    }
+
+    /** Return the durations recorded for \p section. */
+    const LatencyHistogram& At(LoopSection section) const {
+        return spans_[static_cast<std::size_t>(section)];
+    }
+
+   private:
+    static uint64_t Ticks() noexcept {
+        if constexpr (kHasCycleCounter) {
+            return ReadCycleCounter();
+        } else {
+            timespec now = {};
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            return static_cast<uint64_t>(TsToNano(now));
+        }
+    }
+
+    /* Measure, once, how many nanoseconds a tick of Ticks() lasts. */
+    static double NanosPerTick();
+
+    double nanos_per_tick_;
+    std::array<uint64_t, kNumLoopSections> start_;
+    std::array<LatencyHistogram, kNumLoopSections> spans_;
+};
+
+#ifdef GSYNC_SPAN_TIMERS
+/** True when SyncLoop's span timers are compiled in. */
+static constexpr bool kSpanTimers = true;
+#else
+static constexpr bool kSpanTimers = false;
+#endif
+
+#ifdef GSYNC_SPAN_PULSE
+/** True when the span timers time the whole pulse rather than its parts. */
+static constexpr bool kSpanPulse = true;
+#else
+static constexpr bool kSpanPulse = false;
+#endif
+
+/**
+ * Return whether SyncLoop's span timers time \p section. Timing the parts of
+ * the pulse reads the cycle counter and updates a histogram inside the pulse,
+ * so the pulse and its parts are never timed by the same build: the pulse is
+ * timed only if the GSYNC_SPAN_PULSE build option is on, its parts only if it
+ * is off. The sleep is always timed.
+ */
+constexpr bool IsTimedSpan(LoopSection section) {
+    switch (section) {
+        case LoopSection::kPulse:
+            return kSpanPulse;
+        case LoopSection::kSleep:
+            return true;
+        default:
+            return !kSpanPulse;
+    }
+}
+
+/**
+ * Span timers every SyncLoop carries. A SpanProbe if the GSYNC_SPAN_TIMERS
+ * build option is on, otherwise a NullProbe that compiles away. See
+ * IsTimedSpan() for which sections are timed.
+ */
+using LoopSpans = std::conditional_t<kSpanTimers, SpanProbe, NullProbe>;
+
+}  // namespace gsync
+
+#endif
@@ -0,0 +1,96 @@
+#ifndef RATE_H_
+#define RATE_H_
+
+#include <cstdint>
+#include <string>
+
+namespace gsync {
+
+/**
+ * Exact sync rate.
+ *
+ * A SyncRate holds the sync period as the exact rational number of
+ * nanoseconds kNanoPerSec * den / num where num/den is the frequency in
+ * Hertz. Rates such as 29.97 Hz (2997/100) or 30000/1001 Hz don't have an
+ * integer nanosecond period. NextPeriod() hands out integer periods whose
+ * running sum never drifts by more than a nanosecond from the exact
+ * schedule, Bresenham style.
+ */
+class SyncRate {
+   public:
+    /**
+     * Construct a rate from a rational frequency.
+     *
+     * @param[in] num Frequency numerator in Hertz.
+     * @param[in] den Frequency denominator.
+     *
+     * @throws std::runtime_error
+     */
+    static SyncRate FromHz(int64_t num, int64_t den = 1);
+
+    /**
+     * Construct a rate from an integer period.
+     *
+     * @param[in] period_ns Sync period in nanoseconds.
+     *
+     * @throws std::runtime_error
+     */
+    static SyncRate FromPeriodNs(int64_t period_ns);
+
+    /**
+     * Parse a frequency.
+     *
+     * @param[in] str A frequency in Hertz written as an integer ("100"), a
+     * decimal ("29.97") or a fraction ("30000/1001").
+     *
+     * @throws std::runtime_error
+     */
+    static SyncRate Parse(const std::string& str);
+
+    /* The default copy/move constructors and assignment methods will work for
+     * objects of this class. */
+    SyncRate() = delete;
+    ~SyncRate() = default;
+    SyncRate(const SyncRate&) = default;
+    SyncRate& operator=(const SyncRate&) = default;
+    SyncRate(SyncRate&&) = default;
+    SyncRate& operator=(SyncRate&&) = default;
+
+    /** Return the exact period in nanoseconds. */
+    double PeriodNs() const;
+
+    /** Return the period rounded to the nearest nanosecond. */
+    int64_t NominalPeriod() const;
+
+    /** Return the frequency in Hertz. */
+    double Hz() const;
+
+    /**
+     * Return the length of the next period in whole nanoseconds.
+     *
+     * Successive calls alternate between floor and ceil of the exact period
+     * such that the sum of the first N periods is always the exact N period
+     * duration rounded down.
+     */
+    int64_t NextPeriod() {
+        accum_ += remainder_;
+        if (accum_ >= divisor_) {
+            accum_ -= divisor_;
+            return (whole_ + 1);
+        }
+        return whole_;
+    }
+
+   private:
+    SyncRate(int64_t period_num, int64_t period_den);
+
+    int64_t whole_;     /**< Whole nanoseconds per period. */
+    int64_t remainder_; /**< Fractional nanoseconds per period times
+                           divisor_. */
+    int64_t divisor_;   /**< Denominator of the period in nanoseconds. */
+    int64_t accum_;     /**< Accumulated fractional nanoseconds. */
+};
+
+}  // namespace gsync
+
+#endif
@@ -3,23 +3,141 @@
 
 #include <time.h>
 
+#include "sync/adaptive.hpp"
+#include "sync/rate.hpp"
+
 namespace gsync {
 
-class KuramotoSync {
+/**
+ * Sync controller interface.
+ *
+ * A SyncController decides when this participant should next wake up given
+ * its own wakeup time and the last wakeup time reported by its peer. The
+ * control law is selected at startup. Concrete controllers are final so that
+ * the SyncLoop instantiated for each one calls it directly rather than
+ * through this interface.
+ *
+ * Every controller owns the SyncRate it runs at. Both the controller's own
+ * wakeups and the free running NominalWakeup() draw their periods from it so
+ * that the exact long-run rate is kept no matter how often gsync switches
+ * between the two.
+ */
+class SyncController {
+   public:
+    /**
+     * Construct a controller running at the specified rate.
+     *
+     * @param[in] rate Rate at which this task runs.
+     */
+    explicit SyncController(const SyncRate& rate) : rate_(rate) {}
+
+    virtual ~SyncController() = default;
+
+    /** Return the base rate. */
+    const SyncRate& Rate() const { return rate_; }
+
+    /**
+     * Compute the next wakeup using the base rate only.
+     *
+     * @param[in] from The wakeup time to advance by one period.
+     *
+     * @returns \a from advanced by one period.
+     */
+    timespec NominalWakeup(const timespec& from);
+
+    /**
+     * Compute this participant's new wakeup time.
+     *
+     * @param[in] actual_wakeup The time when this participant actually wokeup
+     * to begin its current cycle.
+     * @param[in] peer_wakeup The last wakeup time reported by this
+     * participant's peer.
+     *
+     * @returns The new wakeup time for this participant.
+     */
+    virtual timespec ComputeNewWakeup(const timespec& actual_wakeup,
+                                      const timespec& peer_wakeup) = 0;
+
+   protected:
+    SyncController(const SyncController&) = default;
+    SyncController& operator=(const SyncController&) = default;
+    SyncController(SyncController&&) = default;
+    SyncController& operator=(SyncController&&) = default;
+
+    SyncRate rate_; /**< Base rate and period dithering state. */
+};
+
+/**
+ * Control law shared by the Kuramoto controllers.
+ *
+ * A purely proportional correction on the sine of the phase difference. It
+ * cannot cancel a constant frequency offset between the two participants'
+ * oscillators, see PllSync for a controller that can. Subclasses pick the
+ * coupling constant.
+ */
+class KuramotoModel : public SyncController {
    public:
     static const int kNumParticipants = 2; /**< Machines in the sync loop. */
 
     /**
-     * Construct a Kuramoto sync object with the specified frequency and
-     * coupling constant.
+     * Construct the control law for the specified rate.
+     *
+     * @param[in] rate Rate at which this task runs.
+     */
+    explicit KuramotoModel(const SyncRate& rate);
+
+    virtual ~KuramotoModel() = default;
+
+   protected:
+    KuramotoModel(const KuramotoModel&) = default;
+    KuramotoModel& operator=(const KuramotoModel&) = default;
+    KuramotoModel(KuramotoModel&&) = default;
+    KuramotoModel& operator=(KuramotoModel&&) = default;
+
+    /**
+     * Return the phase difference of \p peer_wakeup from \p actual_wakeup in
+     * radians.
+     */
+    double PhaseDifference(const timespec& actual_wakeup,
+                           const timespec& peer_wakeup) const;
+
+    /**
+     * Apply the Kuramoto correction.
+     *
+     * @param[in] actual_wakeup The time when this participant actually wokeup
+     * to begin its current cycle.
+     * @param[in] dtheta_ji The phase difference from PhaseDifference().
+     * @param[in] coupling_constant The coupling constant, K, in the Kuramoto
+     * Model.
+     *
+     * @returns The new wakeup time for this participant.
+     */
+    timespec Correct(const timespec& actual_wakeup, double dtheta_ji,
+                     double coupling_constant);
+
+    static constexpr double kPi = 3.141592653589793;
+
+   private:
+    double rad_per_nano_; /**< Nanoseconds to radians at rate_. */
+    double nano_per_rad_; /**< Radians to nanoseconds at rate_. */
+};
+
+/**
+ * First-order Kuramoto controller with a fixed coupling constant.
+ */
+class KuramotoSync final : public KuramotoModel {
+   public:
+    /**
+     * Construct a Kuramoto sync object with the specified rate and coupling
+     * constant.
      *
-     * @param[in] frequency Frequency in Hertz at which this task runs.
+     * @param[in] rate Rate at which this task runs.
      * @param[in] coupling_constant The coupling constant, K, in the Kuramoto
      * Model.
      *
      * @throws std::runtime_error
      */
-    KuramotoSync(int frequency, double coupling_constant);
+    KuramotoSync(const SyncRate& rate, double coupling_constant);
 
     /* The default copy/move constructors and assignment methods will work for
      * objects of this class. */
@@ -30,9 +148,6 @@ class KuramotoSync {
     KuramotoSync(KuramotoSync&&) = default;
     KuramotoSync& operator=(KuramotoSync&&) = default;
 
-    /** Return the base frequency in Hertz. */
-    int Frequency() const { return frequency_; }
-
     /** Return the coupling constant. */
     double CouplingConstant() const { return coupling_constant_; }
 
@@ -48,19 +163,63 @@ class KuramotoSync {
      * closer to or keep him in sync with his peer.
      */
     timespec ComputeNewWakeup(const timespec& actual_wakeup,
-                              const timespec& peer_wakeup) const;
+                              const timespec& peer_wakeup) override;
 
    private:
-    static constexpr double kSecToNano = 1e9;
-    static constexpr double kPi = 3.141592653589793;
+    double coupling_constant_;
+};
+
+/**
+ * First-order Kuramoto controller with an adaptive coupling constant.
+ *
+ * Same control law as KuramotoSync, but the coupling constant is retuned
+ * every cycle by an AdaptiveCoupling fed the wrapped phase error.
+ */
+class AdaptiveKuramotoSync final : public KuramotoModel {
+   public:
+    /**
+     * Construct a Kuramoto sync object with the specified rate and an
+     * adaptive coupling constant.
+     *
+     * @param[in] rate Rate at which this task runs.
+     * @param[in] adaptive Bounds and decay rate of the coupling constant.
+     *
+     * @throws std::runtime_error
+     */
+    AdaptiveKuramotoSync(const SyncRate& rate,
+                         const AdaptiveCoupling::Config& adaptive);
+
+    /* The default copy/move constructors and assignment methods will work for
+     * objects of this class. */
+    AdaptiveKuramotoSync() = delete;
+    ~AdaptiveKuramotoSync() = default;
+    AdaptiveKuramotoSync(const AdaptiveKuramotoSync&) = default;
+    AdaptiveKuramotoSync& operator=(const AdaptiveKuramotoSync&) = default;
+    AdaptiveKuramotoSync(AdaptiveKuramotoSync&&) = default;
+    AdaptiveKuramotoSync& operator=(AdaptiveKuramotoSync&&) = default;
 
-    double ToNano(const timespec& ts) const;
-    double NanoToRad(double ns) const;
-    double RadToNano(double rad) const;
-    void NormalizeTime(timespec& ts) const;
+    /** Return the current coupling constant. */
+    double CouplingConstant() const { return adaptive_.K(); }
 
-    int frequency_;
-    double coupling_constant_;
+    /** Return the adaptive coupling state. */
+    const AdaptiveCoupling& Adaptive() const { return adaptive_; }
+
+    /**
+     * Adapt the coupling constant to the phase error, then run the Kuramoto
+     * algorithm to compute this participant's new wakeup time.
+     *
+     * @param[in] actual_wakeup The time when this participant actually wokeup
+     * to begin its current cycle.
+     * @param[in] peer_wakeup The last wakeup time reported by this
+     * participant's peer.
+     *
+     * @returns The new wakeup time for this participant.
+     */
+    timespec ComputeNewWakeup(const timespec& actual_wakeup,
+                              const timespec& peer_wakeup) override;
+
+   private:
+    AdaptiveCoupling adaptive_;
 };
 
 }  // namespace gsync
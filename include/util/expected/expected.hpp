@@ -0,0 +1,92 @@
+#ifndef EXPECTED_H_
+#define EXPECTED_H_
+
+#include <cerrno>
+#include <system_error>
+
+namespace gsync {
+
+/**
+ * Value or error code result.
+ *
+ * A stand-in for C++23's std::expected<T, std::error_code> used by the
+ * non-throwing APIs the real-time loops call. Neither constructing nor
+ * inspecting an Expected allocates or throws, so code built with
+ * -fno-exceptions can use it.
+ *
+ * @tparam T Value type. Must be default constructible.
+ */
+template <typename T>
+class Expected {
+   public:
+    /** Construct a result holding \p value. */
+    Expected(const T& value) : value_(value), error_() {}
+
+    /** Construct a result holding error \p error. */
+    Expected(std::error_code error) : value_(), error_(error) {}
+
+    /* The default copy/move constructors and assignment methods will work for
+     * objects of this class. */
+    Expected() = delete;
+    ~Expected() = default;
+    Expected(const Expected&) = default;
+    Expected& operator=(const Expected&) = default;
+    Expected(Expected&&) = default;
+    Expected& operator=(Expected&&) = default;
+
+    /** Return true if this result holds a value. */
+    bool HasValue() const { return !error_; }
+
+    /** Return true if this result holds a value. */
+    explicit operator bool() const { return HasValue(); }
+
+    /** Return the value. Only meaningful if HasValue(). */
+    const T& Value() const { return value_; }
+
+    /** Return the error. Only meaningful if !HasValue(). */
+    std::error_code Error() const { return error_; }
+
+   private:
+    T value_;
+    std::error_code error_;
+};
+
+/** Result of an operation that produces no value. */
+template <>
+class Expected<void> {
+   public:
+    /** Construct a successful result. */
+    Expected() : error_() {}
+
+    /** Construct a result holding error \p error. */
+    Expected(std::error_code error) : error_(error) {}
+
+    /* The default copy/move constructors and assignment methods will work for
+     * objects of this class. */
+    ~Expected() = default;
+    Expected(const Expected&) = default;
+    Expected& operator=(const Expected&) = default;
+    Expected(Expected&&) = default;
+    Expected& operator=(Expected&&) = default;
+
+    /** Return true if the operation succeeded. */
+    bool HasValue() const { return !error_; }
+
+    /** Return true if the operation succeeded. */
+    explicit operator bool() const { return HasValue(); }
+
+    /** Return the error. Only meaningful if !HasValue(). */
+    std::error_code Error() const { return error_; }
+
+   private:
+    std::error_code error_;
+};
+
+/** Return \p err, \a errno by default, as an error code. */
+inline std::error_code ErrnoError(int err = errno) {
+    return std::error_code(err, std::generic_category());
+}
+
+}  // namespace gsync
+
+#endif
@@ -0,0 +1,84 @@
+#ifndef GPIO_BACKEND_H_
+#define GPIO_BACKEND_H_
+
+#include <time.h>
+
+#include <string>
+
+#include "util/expected/expected.hpp"
+#include "util/gpio/gpio.hpp"
+
+namespace gsync {
+
+/**
+ * GPIO line backend.
+ *
+ * Gpio forwards all line operations to a GpioBackend. The backend is picked
+ * by Gpio's constructor based off of the device name. Setting up a line
+ * throws on failure. The operations the real-time loops use don't throw,
+ * they return an error code instead.
+ */
+class GpioBackend {
+   public:
+    virtual ~GpioBackend() = default;
+
+    /** Return the chip label. */
+    virtual std::string ChipLabel() const = 0;
+
+    /** Return the chip name. */
+    virtual std::string ChipName() const = 0;
+
+    /** Return the line name. */
+    virtual std::string LineName() const = 0;
+
+    /** Return the line offset. */
+    virtual unsigned int LineOffset() const = 0;
+
+    /** Request the line as a plain input or output. */
+    virtual void Request(const std::string& consumer,
+                         Gpio::Direction direction) = 0;
+
+    /** Request edge events on the line. */
+    virtual void RequestEdge(const std::string& consumer, Gpio::Edge edge) = 0;
+
+    /** Set or clear the line's \a active_low setting. */
+    virtual void SetActiveLow(const std::string& consumer, bool is_low) = 0;
+
+    /** Drive the line to \p value. */
+    virtual Expected<void> SetValue(int value) = 0;
+
+    /** Return the line's value. */
+    virtual Expected<int> GetValue() const = 0;
+
+    /**
+     * Block indefinitely until a requested edge event occurs. A signal
+     * interrupts the wait with std::errc::interrupted.
+     *
+     * @returns The time the edge was seen by the kernel, on CLOCK_MONOTONIC.
+     */
+    virtual Expected<timespec> WaitForEdge() = 0;
+
+   protected:
+    GpioBackend() = default;
+    GpioBackend(const GpioBackend&) = default;
+    GpioBackend& operator=(const GpioBackend&) = default;
+    GpioBackend(GpioBackend&&) = default;
+    GpioBackend& operator=(GpioBackend&&) = default;
+};
+
+/**
+ * Line policy that drives nothing. Stands in for an optional output line,
+ * e.g., gtimer's echo line, in policy-based event loops.
+ */
+class NullLine {
+   public:
+    /** Does nothing. */
+    Expected<void> SetValue(int value) {
+        (void)value;
+        return {};
+    }
+};
+
+}  // namespace gsync
+
+#endif
@@ -1,16 +1,25 @@
 #ifndef GPIO_H_
 #define GPIO_H_
 
-#include <gpiod.hpp>
+#include <time.h>
+
+#include <memory>
 #include <string>
 
+#include "util/expected/expected.hpp"
+
 namespace gsync {
 
+class GpioBackend;
+
 /**
  * GPIO control utility.
  *
- * A wrapper around libgpiod's C++ bindings. Note, Gpio propagates the std
- * exceptions that are thrown by libgpiod!
+ * A wrapper around libgpiod. Device names of the form "vgpio:<bus>" select a
+ * virtual GPIO bus in shared memory instead, see VirtualGpioBackend. Gpio
+ * throws std::system_error on failure. The Try* variants of the calls made
+ * from real-time loops return an error code instead, so they can be used
+ * from code built with -fno-exceptions.
  */
 class Gpio {
    public:
@@ -37,7 +46,7 @@ class Gpio {
     /**
      * Construct a GPIO controller.
      *
-     * @param[in] dev GPIO device name (e.g., /dev/gpiochip0).
+     * @param[in] dev GPIO device name (e.g., /dev/gpiochip0 or vgpio:bus0).
      * @param[in] line GPIO line offset.
      * @param[in] name Optional GPIO pin name.
      */
@@ -46,6 +55,7 @@ class Gpio {
 
     Gpio() = delete;
 
+    /* Copies share the underlying line, just like gpiod::line copies do. */
     ~Gpio() = default;
     Gpio(const Gpio&) = default;
     Gpio& operator=(const Gpio&) = default;
@@ -53,16 +63,16 @@ class Gpio {
     Gpio& operator=(Gpio&&) = default;
 
     /** Return the chip label. */
-    std::string ChipLabel() const { return chip_.label(); }
+    std::string ChipLabel() const;
 
     /** Return the chip name. */
-    std::string ChipName() const { return chip_.name(); }
+    std::string ChipName() const;
 
     /** Return the line name. */
-    std::string LineName() const { return line_.name(); }
+    std::string LineName() const;
 
     /** Return the line offset. */
-    unsigned int LineOffset() const { return line_.offset(); }
+    unsigned int LineOffset() const;
 
     /** Set the GPIO in/out direction. */
     void Dir(Direction direction);
@@ -73,9 +83,15 @@ class Gpio {
     /** Set the GPIO to a low/high value. */
     void Val(Value value) const;
 
+    /** Set the GPIO to a low/high value without throwing. */
+    Expected<void> TryVal(Value value) const;
+
     /** Return the current low/high value of the GPIO. */
     Value Val() const;
 
+    /** Return the current low/high value of the GPIO without throwing. */
+    Expected<Value> TryVal() const;
+
     /** Set the GPIO edge type. */
     void EdgeType(Gpio::Edge edge);
 
@@ -96,12 +112,25 @@ class Gpio {
     /** Toggle the GPIO output value. */
     void ToggleOutput() const;
 
-    /** Block indefinitely until an edge triggered event is detected. */
-    void WaitForEdge();
+    /**
+     * Block indefinitely until an edge triggered event is detected.
+     *
+     * @returns The time the kernel saw the edge, see
+     * GpioBackend::WaitForEdge().
+     */
+    timespec WaitForEdge();
+
+    /**
+     * Block indefinitely until an edge triggered event is detected, without
+     * throwing. A signal interrupts the wait with std::errc::interrupted.
+     */
+    Expected<timespec> TryWaitForEdge();
+
+    /** Return the backend, see ResolveBackend(). */
+    GpioBackend& Backend() const { return *backend_; }
 
    private:
-    gpiod::chip chip_;
-    gpiod::line line_;
+    std::shared_ptr<GpioBackend> backend_;
     std::string name_;
     Direction dir_;
     Edge edge_;
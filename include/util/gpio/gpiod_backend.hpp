@@ -0,0 +1,86 @@
+#ifndef GPIOD_BACKEND_H_
+#define GPIOD_BACKEND_H_
+
+#include <gpiod.h>
+
+#include <string>
+
+#include "util/expected/expected.hpp"
+#include "util/gpio/backend.hpp"
+
+namespace gsync {
+
+/**
+ * libgpiod GPIO backend.
+ *
+ * Drives real GPIO character devices (e.g., /dev/gpiochip0) through
+ * libgpiod's C API. Setting up the line throws std::system_error on failure.
+ * SetValue(), GetValue() and WaitForEdge() return errors instead of
+ * throwing.
+ */
+class GpiodBackend final : public GpioBackend {
+   public:
+    /**
+     * Open a line on a GPIO chip.
+     *
+     * @param[in] dev GPIO device name, path, label or number (e.g.,
+     * /dev/gpiochip0).
+     * @param[in] offset GPIO line offset.
+     *
+     * @throws std::system_error
+     */
+    GpiodBackend(const std::string& dev, int offset);
+
+    /* Each backend owns its own chip handle and line request. */
+    GpiodBackend() = delete;
+    ~GpiodBackend() override;
+    GpiodBackend(const GpiodBackend&) = delete;
+    GpiodBackend& operator=(const GpiodBackend&) = delete;
+    GpiodBackend(GpiodBackend&&) = delete;
+    GpiodBackend& operator=(GpiodBackend&&) = delete;
+
+    std::string ChipLabel() const override;
+    std::string ChipName() const override;
+    std::string LineName() const override;
+    unsigned int LineOffset() const override;
+    void Request(const std::string& consumer,
+                 Gpio::Direction direction) override;
+    void RequestEdge(const std::string& consumer, Gpio::Edge edge) override;
+    void SetActiveLow(const std::string& consumer, bool is_low) override;
+
+    Expected<void> SetValue(int value) override {
+        if (-1 == gpiod_line_set_value(line_, value)) {
+            return ErrnoError();
+        }
+        return {};
+    }
+
+    Expected<int> GetValue() const override {
+        int value = gpiod_line_get_value(line_);
+        if (-1 == value) {
+            return ErrnoError();
+        }
+        return value;
+    }
+
+    /**
+     * Block until a requested edge event occurs.
+     *
+     * @returns The event's kernel timestamp. Linux stamps line events with
+     * CLOCK_MONOTONIC since 5.7, older kernels use CLOCK_REALTIME.
+     */
+    Expected<timespec> WaitForEdge() override;
+
+   private:
+    /* (Re)request the line with the current request type and flags. */
+    void Rerequest(const std::string& consumer);
+
+    gpiod_chip* chip_;
+    gpiod_line* line_;
+    int request_type_; /**< GPIOD_LINE_REQUEST_*, 0 if not requested. */
+    bool active_low_;
+};
+
+}  // namespace gsync
+
+#endif
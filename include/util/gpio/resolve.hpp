@@ -0,0 +1,32 @@
+#ifndef GPIO_RESOLVE_H_
+#define GPIO_RESOLVE_H_
+
+#include <variant>
+
+#include "util/gpio/gpio.hpp"
+#include "util/gpio/gpiod_backend.hpp"
+#include "util/gpio/vgpio.hpp"
+
+namespace gsync {
+
+/** A Gpio's backend, resolved to its concrete type. */
+using ConcreteBackend = std::variant<GpiodBackend*, VirtualGpioBackend*>;
+
+/**
+ * Resolve a Gpio's backend to its concrete type.
+ *
+ * Gpio goes through the GpioBackend interface on every call. Event loops
+ * resolve the backend once, at startup, and instantiate themselves on the
+ * concrete (final) backend type so that driving or waiting on the line is a
+ * direct call.
+ *
+ * @param[in] gpio The GPIO whose backend to resolve. The returned pointer
+ * shares its lifetime with \p gpio.
+ *
+ * @throws std::runtime_error
+ */
+ConcreteBackend ResolveBackend(const Gpio& gpio);
+
+}  // namespace gsync
+
+#endif
@@ -0,0 +1,119 @@
+#ifndef VGPIO_H_
+#define VGPIO_H_
+
+#include <atomic>
+#include <cstdint>
+#include <random>
+#include <string>
+
+#include "util/expected/expected.hpp"
+#include "util/gpio/backend.hpp"
+
+namespace gsync {
+
+/**
+ * Virtual GPIO backend.
+ *
+ * Lines live on a "bus" in POSIX shared memory, named by the device string
+ * "vgpio:<bus>". Any process that opens the same bus sees the same lines, so
+ * a line works like a wire: whatever one process drives onto it, every other
+ * process reading it sees. A value change bumps the line's edge counters and
+ * wakes every waiter with a futex. Driving a line nobody waits on doesn't
+ * enter the kernel. A bus is created readable and writable by its owner
+ * only, every process on it must run as the same user.
+ *
+ * To emulate the wire, IRQ and driver latency of a real board, each edge
+ * reaches waiters GSYNC_VGPIO_DELAY_NS nanoseconds after it was driven plus
+ * a uniformly distributed extra of up to GSYNC_VGPIO_JITTER_NS nanoseconds.
+ * Both environment variables are read by the writing process and default to
+ * zero.
+ *
+ * Unlike a real GPIO chip, edges aren't queued. A waiter that falls behind
+ * sees all of the edges it missed as one.
+ */
+class VirtualGpioBackend final : public GpioBackend {
+   public:
+    static constexpr const char* kDevPrefix = "vgpio:"; /**< Device prefix. */
+    static const int kMaxLines = 64; /**< Number of lines on each bus. */
+
+    /**
+     * Open a line on a virtual bus. The bus is created if it doesn't exist.
+     *
+     * @param[in] bus Bus name.
+     * @param[in] offset Line offset in the range [0, kMaxLines).
+     *
+     * @throws std::runtime_error
+     */
+    VirtualGpioBackend(const std::string& bus, int offset);
+
+    /* Each backend owns its own mapping of the bus. */
+    VirtualGpioBackend() = delete;
+    ~VirtualGpioBackend() override;
+    VirtualGpioBackend(const VirtualGpioBackend&) = delete;
+    VirtualGpioBackend& operator=(const VirtualGpioBackend&) = delete;
+    VirtualGpioBackend(VirtualGpioBackend&&) = delete;
+    VirtualGpioBackend& operator=(VirtualGpioBackend&&) = delete;
+
+    /** Return true if \p dev names a virtual bus. */
+    static bool IsVirtual(const std::string& dev);
+
+    /** Remove the bus named \p bus from shared memory. */
+    static void Unlink(const std::string& bus);
+
+    std::string ChipLabel() const override { return "vgpio"; }
+    std::string ChipName() const override { return bus_; }
+    std::string LineName() const override { return consumer_; }
+    unsigned int LineOffset() const override { return offset_; }
+    void Request(const std::string& consumer,
+                 Gpio::Direction direction) override;
+    void RequestEdge(const std::string& consumer, Gpio::Edge edge) override;
+    void SetActiveLow(const std::string& consumer, bool is_low) override;
+    Expected<void> SetValue(int value) override;
+    Expected<int> GetValue() const override;
+
+    /**
+     * Block until a requested edge reaches this line.
+     *
+     * @returns The edge's emulated arrival time, standing in for the time a
+     * real GPIO chip's IRQ would have stamped it with.
+     *
+     * @returns std::errc::interrupted if a signal interrupts the wait, like
+     * libgpiod does. std::errc::invalid_argument if no edge events were
+     * requested.
+     */
+    Expected<timespec> WaitForEdge() override;
+
+    /** Line state shared by every process on the bus. */
+    struct Line {
+        std::atomic<uint32_t> value;      /**< Physical line level. */
+        std::atomic<uint32_t> edges;      /**< Futex word, bumped per edge. */
+        std::atomic<uint32_t> rising;     /**< Rising edge count. */
+        std::atomic<uint32_t> falling;    /**< Falling edge count. */
+        std::atomic<uint32_t> waiters;    /**< Processes blocked on edges. */
+        std::atomic<int64_t> arrival_ns;  /**< CLOCK_MONOTONIC time the last
+                                             edge reaches waiters. */
+    };
+
+    /** Shared memory layout of a bus. */
+    struct Bus {
+        Line lines[kMaxLines];
+    };
+
+   private:
+    std::string bus_;
+    unsigned int offset_;
+    std::string consumer_;
+    Bus* mapping_;
+    Line* line_;
+    Gpio::Edge edge_;
+    bool active_low_;
+    uint32_t seen_rising_;
+    uint32_t seen_falling_;
+    int64_t delay_ns_;
+    int64_t jitter_ns_;
+    std::minstd_rand rng_;
+};
+
+}  // namespace gsync
+
+#endif
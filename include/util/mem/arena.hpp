@@ -0,0 +1,112 @@
+#ifndef ARENA_H_
+#define ARENA_H_
+
+#include <cstddef>
+#include <memory_resource>
+#include <optional>
+
+namespace gsync {
+namespace mem {
+
+/**
+ * Locked memory arena.
+ *
+ * LockedArena is a std::pmr::memory_resource carved out of a single mmap()ed
+ * region that is locked into memory and faulted in when the arena is
+ * constructed. Buffers used by the real-time loops (rings, histograms, peer
+ * tables) should be allocated from an arena at startup so that the loops
+ * never enter malloc() and never take its locks.
+ *
+ * The arena never falls back to the heap. Exhausting it throws
+ * std::bad_alloc. The arena is not thread safe.
+ */
+class LockedArena : public std::pmr::memory_resource {
+   public:
+    /** Allocation strategy. */
+    enum class Strategy {
+        kMonotonic, /**< Bump allocation, deallocation is a no-op. Cheapest
+                       and deterministic, but memory is never reused. */
+        kPool,      /**< Size class pools on top of the bump allocator.
+                       Freed blocks are reused by later allocations. */
+    };
+
+    /** Huge page backing. Huge pages cut the number of TLB entries the
+     * arena needs, and so the TLB misses taken walking its buffers. */
+    enum class HugePages {
+        kNone,        /**< Regular pages. */
+        kTransparent, /**< Ask for transparent huge pages via madvise(). The
+                         kernel falls back to regular pages if it has none to
+                         spare. */
+        kExplicit,    /**< Map pages from the hugetlbfs pool
+                         (vm.nr_hugepages). Fails if the pool is empty. */
+    };
+
+    /**
+     * Construct an arena.
+     *
+     * @param[in] size Arena size in bytes. Rounded up to a whole number of
+     * pages, huge pages if \p huge_pages asks for them.
+     * @param[in] strategy Allocation strategy.
+     * @param[in] huge_pages Huge page backing.
+     *
+     * @throws std::runtime_error
+     */
+    LockedArena(std::size_t size, Strategy strategy,
+                HugePages huge_pages = HugePages::kNone);
+
+    /* Memory resources are referred to by address. Copying or moving an arena
+     * would leave its users dangling. */
+    LockedArena() = delete;
+    ~LockedArena() override;
+    LockedArena(const LockedArena&) = delete;
+    LockedArena& operator=(const LockedArena&) = delete;
+    LockedArena(LockedArena&&) = delete;
+    LockedArena& operator=(LockedArena&&) = delete;
+
+    /** Return the arena size in bytes. */
+    std::size_t Capacity() const { return region_.size; }
+
+    /** Return the number of bytes currently handed out. */
+    std::size_t BytesInUse() const { return in_use_; }
+
+    /** Return the largest number of bytes ever handed out at once. */
+    std::size_t PeakBytesInUse() const { return peak_in_use_; }
+
+    /** Return the arena's allocation strategy. */
+    Strategy ArenaStrategy() const { return strategy_; }
+
+    /** Return the arena's huge page backing. */
+    HugePages ArenaHugePages() const { return region_.huge_pages; }
+
+   private:
+    /* Owns the locked mapping. Declared first so it is unmapped last. */
+    struct Region {
+        Region(std::size_t len, HugePages huge);
+        ~Region();
+        Region(const Region&) = delete;
+        Region& operator=(const Region&) = delete;
+
+        void* addr;
+        std::size_t size;
+        HugePages huge_pages;
+    };
+
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+    void do_deallocate(void* p, std::size_t bytes,
+                       std::size_t alignment) override;
+    bool do_is_equal(
+        const std::pmr::memory_resource& other) const noexcept override;
+
+    Region region_;
+    Strategy strategy_;
+    std::pmr::monotonic_buffer_resource monotonic_;
+    std::optional<std::pmr::unsynchronized_pool_resource> pool_;
+    std::pmr::memory_resource* resource_;
+    std::size_t in_use_;
+    std::size_t peak_in_use_;
+};
+
+}  // namespace mem
+}  // namespace gsync
+
+#endif
@@ -1,42 +1,178 @@
 #ifndef MEM_H_
 #define MEM_H_
 
+#include <cstddef>
+#include <optional>
 #include <string>
 
+#include "util/expected/expected.hpp"
+
 namespace gsync {
 namespace mem {
 
 static const int kMaxStackSize = 512 * 1024; /**< 512kib default stack size. */
 static const int kMaxHeapSize = 8 * 1024 * 1024; /**< 8Mib default heap size. */
 
-/** Lock all process pages in memory, disable \a mmap usage, and disable heap
- * trimming.
+/** Minimum headroom prefaulted on top of a measured peak in auto mode. */
+static const int kMinAutoMargin = 64 * 1024;
+
+/** Fraction of a measured peak prefaulted on top of it in auto mode. */
+static const double kAutoMarginFraction = 0.25;
+
+/** Which pages get locked into memory. */
+enum class LockPolicy {
+    kAll,     /**< mlockall(MCL_CURRENT | MCL_FUTURE): every mapped page,
+                 including all of every shared library, is faulted in and
+                 locked. */
+    kOnFault, /**< mlockall() with MCL_ONFAULT: pages are locked as they are
+                 first touched. Untouched library pages cost nothing. */
+    kRegions, /**< No mlockall(). Only the prefaulted stack and heap, and
+                 regions locked explicitly (e.g., a LockedArena), are
+                 locked. */
+};
+
+/** Prefault sizes and lock policy. An empty size selects auto mode for that
+ * region: nothing is prefaulted up front and PrefaultMeasured() sizes the
+ * region off of the peak usage seen during the program's warm-up instead. */
+struct Config {
+    std::optional<std::size_t> stack_size = kMaxStackSize; /**< Stack bytes. */
+    std::optional<std::size_t> heap_size = kMaxHeapSize;   /**< Heap bytes. */
+    LockPolicy lock = LockPolicy::kAll; /**< Lock policy. */
+};
+
+/** Peak memory usage of the process. */
+struct Usage {
+    std::size_t stack_bytes = 0; /**< Size of the main thread's stack. */
+    std::size_t heap_bytes = 0;  /**< Size of the main malloc arena. */
+};
+
+/** Return the system page size. The value is looked up once and cached. */
+std::size_t PageSize();
+
+/**
+ * Return the default huge page size. The value is looked up once and cached.
+ *
+ * @throws std::runtime_error
+ */
+std::size_t HugePageSize();
+
+/**
+ * Parse a lock policy: "all", "onfault" or "regions".
+ *
+ * @throws std::runtime_error
+ */
+LockPolicy ParseLockPolicy(const std::string& str);
+
+/**
+ * Lock the pages spanning [\p addr, \p addr + \p len) into memory.
+ *
+ * @throws std::runtime_error
+ */
+void LockRegion(const void* addr, std::size_t len);
+
+/**
+ * Lock the main malloc arena, from the start of the heap to the program
+ * break, into memory.
+ *
+ * @throws std::runtime_error
+ */
+void LockHeap();
+
+/**
+ * Return the number of bytes the process has locked into memory (VmLck).
+ *
+ * VmLck counts the size of the locked mappings. Under LockPolicy::kOnFault,
+ * only the resident part of those mappings is actually pinned, see
+ * ResidentBytes().
+ *
+ * @throws std::runtime_error
+ */
+std::size_t LockedBytes();
+
+/**
+ * Return the process' resident set size in bytes (VmRSS).
+ *
+ * @throws std::runtime_error
+ */
+std::size_t ResidentBytes();
+
+/**
+ * Parse a memory size such as "4096", "512K", "8M" or "1G".
+ *
+ * @throws std::runtime_error
+ */
+std::size_t ParseSize(const std::string& str);
+
+/** Lock process pages in memory according to \p policy, disable \a mmap
+ * usage, and disable heap trimming.
+ *
+ * @throws std::runtime_error
+ */
+void ConfigureMallocForRt(LockPolicy policy = LockPolicy::kAll);
+
+/** Trigger as many page faults as needed to have a stack of size \p size
+ * locked into memory. The size counts from the top of the main thread's
+ * stack, frames already on it included. With \p lock set, the prefaulted
+ * pages are locked explicitly rather than relying on mlockall().
+ *
+ * @throws std::runtime_error
+ */
+void PrefaultStack(std::size_t size = kMaxStackSize, bool lock = false);
+
+/** Trigger as many page faults as needed to have a heap of size \p size
+ * locked into memory. The size counts from the base of the main malloc
+ * arena, chunks already in it included. With \p lock set, the whole heap is
+ * locked explicitly rather than relying on mlockall().
  *
  * @throws std::runtime_error
  */
-void ConfigureMallocForRt();
+void PrefaultHeap(std::size_t size = kMaxHeapSize, bool lock = false);
 
-/** Trigger as many page faults as needed to have a stack of size
- * mem::kMaxStackSize locked into memory. */
-void PrefaultStack();
+/**
+ * Return the peak stack and heap usage of the process so far.
+ *
+ * Neither region ever shrinks once ConfigureMallocForRt() has disabled heap
+ * trimming, so their current sizes are their high water marks.
+ *
+ * @throws std::runtime_error
+ */
+Usage PeakUsage();
 
-/** Trigger as many page faults as needed to have a heap of size
- * mem::kMaxHeapSize locked into memory.
+/**
+ * Prefault the auto sized regions of \p config.
+ *
+ * Call this once the program has warmed up, i.e., after it has run through
+ * its setup and first iterations. Each auto sized region ends up with its
+ * measured peak plus a margin locked into memory. Under
+ * LockPolicy::kRegions, the warm-up's pages aren't locked yet and the whole
+ * amount is prefaulted and locked.
+ *
+ * @returns The number of bytes locked for each auto sized region.
  *
  * @throws std::runtime_error
  */
-void PrefaultHeap();
+Usage PrefaultMeasured(const Config& config);
+
+/**
+ * PrefaultMeasured() for callers built with -fno-exceptions.
+ *
+ * @returns The number of bytes locked for each auto sized region, or the
+ *          \a errno of the failed call, \a EIO if there was none.
+ */
+Expected<Usage> TryPrefaultMeasured(const Config& config);
 
 /**
  * Make the processes' memory layout real-time friendly.
  *
+ * Regions of \p config in auto mode are left for PrefaultMeasured().
+ *
  * See the "Memory Management" section of
  * https://programmador.com/posts/real-time-linux-app-development/
  * for details.
  *
  * @throws std::runtime_error
  */
-void ConfigureMemForRt();
+void ConfigureMemForRt(const Config& config = Config());
 
 }  // namespace mem
 }  // namespace gsync
@@ -0,0 +1,102 @@
+#ifndef HISTOGRAM_H_
+#define HISTOGRAM_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace gsync {
+
+/**
+ * Histogram of nanosecond durations.
+ *
+ * Buckets are log-linear: each power of two is split into kSubBuckets
+ * equal buckets, so a bucket is never wider than 1/kSubBuckets of the values
+ * it holds. Durations below kSubBuckets ns get a bucket each. Durations past
+ * kMaxExponent are counted in the last bucket. The exact minimum, maximum
+ * and mean are tracked on the side.
+ *
+ * All storage is inline. Add() neither allocates nor throws.
+ */
+class LatencyHistogram {
+   public:
+    static constexpr int kSubBucketBits = 4; /**< log2 of kSubBuckets. */
+    static constexpr int64_t kSubBuckets = 1 << kSubBucketBits; /**< Buckets
+                                                    per power of two. */
+    static constexpr int kMaxExponent = 36; /**< Largest power of two
+                                               bucketed, about 69 s. */
+    /** Number of buckets. */
+    static constexpr std::size_t kNumBuckets =
+        kSubBuckets + ((kMaxExponent - kSubBucketBits + 1) * kSubBuckets);
+
+    /* The default copy/move constructors and assignment methods will work for
+     * objects of this class. */
+    LatencyHistogram() = default;
+    ~LatencyHistogram() = default;
+    LatencyHistogram(const LatencyHistogram&) = default;
+    LatencyHistogram& operator=(const LatencyHistogram&) = default;
+    LatencyHistogram(LatencyHistogram&&) = default;
+    LatencyHistogram& operator=(LatencyHistogram&&) = default;
+
+    /** Record a duration of \p ns nanoseconds, negative values count as 0. */
+    void Add(int64_t ns) noexcept {
+        ns = (ns < 0) ? 0 : ns;
+        buckets_[BucketOf(ns)]++;
+        min_ = (!count_ || (ns < min_)) ? ns : min_;
+        max_ = (ns > max_) ? ns : max_;
+        sum_ += ns;
+        count_++;
+    }
+
+    /** Forget every recorded duration. */
+    void Reset() { *this = LatencyHistogram(); }
+
+    /** Return the number of recorded durations. */
+    uint64_t Count() const { return count_; }
+
+    /** Return the smallest recorded duration, 0 if there are none. */
+    int64_t Min() const { return min_; }
+
+    /** Return the largest recorded duration, 0 if there are none. */
+    int64_t Max() const { return max_; }
+
+    /** Return the mean recorded duration, 0 if there are none. */
+    double Mean() const {
+        return (count_) ? (static_cast<double>(sum_) /
+                           static_cast<double>(count_))
+                        : 0.0;
+    }
+
+    /**
+     * Return the duration that \p p of the recorded durations don't exceed,
+     * e.g., Percentile(0.99). The result is the upper edge of the bucket the
+     * percentile falls in, clamped to Max().
+     *
+     * @param[in] p Fraction in [0, 1].
+     */
+    int64_t Percentile(double p) const;
+
+   private:
+    static std::size_t BucketOf(int64_t ns) {
+        if (ns < kSubBuckets) {
+            return static_cast<std::size_t>(ns);
+        }
+        int exponent = 63 - __builtin_clzll(static_cast<uint64_t>(ns));
+        if (exponent > kMaxExponent) {
+            return kNumBuckets - 1;
+        }
+        int64_t sub = (ns >> (exponent - kSubBucketBits)) - kSubBuckets;
+        return static_cast<std::size_t>(
+            kSubBuckets + ((exponent - kSubBucketBits) * kSubBuckets) + sub);
+    }
+
+    std::array<uint64_t, kNumBuckets> buckets_ = {};
+    uint64_t count_ = 0;
+    int64_t min_ = 0;
+    int64_t max_ = 0;
+    int64_t sum_ = 0;
+};
+
+}  // namespace gsync
+
+#endif
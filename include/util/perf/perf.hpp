@@ -0,0 +1,102 @@
+#ifndef PERF_H_
+#define PERF_H_
+
+#include <cstdint>
+
+struct perf_event_mmap_page;
+
+namespace gsync {
+
+/**
+ * Hardware performance counter.
+ *
+ * PerfCounter wraps a perf_event_open() counter that follows the calling
+ * thread across CPUs. Counters are created disabled. Only events that occur
+ * while the thread is running are counted, time spent sleeping doesn't
+ * contribute. Hardware events only count user space, so they only need
+ * kernel.perf_event_paranoid <= 2, the default.
+ *
+ * Each counter also maps the kernel's perf_event_mmap_page. On x86, where
+ * the kernel allows it, ReadFast() then reads the hardware counter directly
+ * with rdpmc instead of making a read() system call.
+ */
+class PerfCounter {
+   public:
+    /** Counted event. */
+    enum class Event {
+        kCycles,          /**< CPU cycles. */
+        kInstructions,    /**< Retired instructions. */
+        kCacheMisses,     /**< Last level cache misses. */
+        kDtlbReadMisses,  /**< Data TLB load misses. */
+        kDtlbWriteMisses, /**< Data TLB store misses. */
+        kItlbReadMisses,  /**< Instruction TLB misses. */
+        kBranchMisses,    /**< Mispredicted branches. */
+        kContextSwitches, /**< Context switches, a software event. Only
+                             counted if kernel events may be counted, i.e.,
+                             kernel.perf_event_paranoid <= 1 or
+                             CAP_PERFMON. */
+    };
+
+    /**
+     * Open a counter for the calling thread.
+     *
+     * @throws std::runtime_error If the event isn't supported by the PMU or
+     * access is denied by kernel.perf_event_paranoid.
+     */
+    explicit PerfCounter(Event event);
+
+    /* Counters own a file descriptor. Copying is not allowed, moving
+     * transfers ownership. */
+    PerfCounter() = delete;
+    ~PerfCounter();
+    PerfCounter(const PerfCounter&) = delete;
+    PerfCounter& operator=(const PerfCounter&) = delete;
+    PerfCounter(PerfCounter&& other) noexcept;
+    PerfCounter& operator=(PerfCounter&& other) noexcept;
+
+    /** Start counting. */
+    void Enable();
+
+    /** Stop counting. */
+    void Disable();
+
+    /** Zero the count. */
+    void Reset();
+
+    /**
+     * Return the current count.
+     *
+     * @throws std::runtime_error
+     */
+    uint64_t Read() const;
+
+    /**
+     * Return the current count without throwing. Uses rdpmc if UserReadable(),
+     * \a read() otherwise.
+     *
+     * @returns The count, 0 if it couldn't be read.
+     */
+    uint64_t ReadFast() const noexcept;
+
+    /**
+     * Return true if ReadFast() can currently read the counter from user
+     * space. Only true while the counter is enabled.
+     */
+    bool UserReadable() const;
+
+    /** Return the counted event. */
+    Event CountedEvent() const { return event_; }
+
+    /** Return a short name for \p event, e.g., "dtlb_read_misses". */
+    static const char* Name(Event event);
+
+   private:
+    Event event_;
+    int fd_;
+    perf_event_mmap_page* page_; /**< Counter's metadata page, nullptr if it
+                                    couldn't be mapped. */
+};
+
+}  // namespace gsync
+
+#endif
@@ -0,0 +1,113 @@
+#ifndef SECTIONS_H_
+#define SECTIONS_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+#include "util/perf/perf.hpp"
+
+namespace gsync {
+
+/**
+ * Hardware counter statistics for numbered sections of a loop.
+ *
+ * SectionCounters reads a set of PerfCounters at the start and end of each
+ * section and accumulates the difference into that section's stats. All
+ * storage is allocated at construction, Begin() and End() neither allocate
+ * nor throw. Counters are read with PerfCounter::ReadFast(): hardware events
+ * cost an rdpmc each where the kernel allows it, software events always
+ * cost a \a read() system call.
+ */
+class SectionCounters {
+   public:
+    static constexpr std::size_t kMaxSections = 8; /**< Section limit. */
+    static constexpr std::size_t kMaxEvents = 6;   /**< Event limit. */
+
+    /** One event's counts over every pass through a section. */
+    struct Stats {
+        uint64_t samples = 0; /**< Passes through the section. */
+        uint64_t total = 0;   /**< Sum of the counts. */
+        uint64_t max = 0;     /**< Largest count of a single pass. */
+
+        /** Return the mean count per pass. */
+        double Mean() const {
+            return (samples) ? (static_cast<double>(total) /
+                                static_cast<double>(samples))
+                             : 0.0;
+        }
+    };
+
+    /**
+     * Open and enable a counter for each of \p events for the calling
+     * thread. Events the PMU or kernel won't count are skipped and listed by
+     * Skipped().
+     *
+     * @throws std::runtime_error If none of the events could be opened or
+     * there are more than kMaxEvents.
+     */
+    explicit SectionCounters(std::initializer_list<PerfCounter::Event> events);
+
+    /* No reason to copy or move SectionCounters objects at this time. */
+    SectionCounters() = delete;
+    ~SectionCounters() = default;
+    SectionCounters(const SectionCounters&) = delete;
+    SectionCounters& operator=(const SectionCounters&) = delete;
+    SectionCounters(SectionCounters&&) = delete;
+    SectionCounters& operator=(SectionCounters&&) = delete;
+
+    /** Mark the start of section \p section, less than kMaxSections. */
+    void Begin(std::size_t section) noexcept {
+        for (std::size_t i = 0; i < counters_.size(); ++i) {
+            start_[section][i] = counters_[i].ReadFast();
+        }
+    }
+
+    /** Mark the end of section \p section and accumulate its counts. */
+    void End(std::size_t section) noexcept {
+        for (std::size_t i = 0; i < counters_.size(); ++i) {
+            uint64_t count = counters_[i].ReadFast() - start_[section][i];
+            Stats& stats = stats_[section][i];
+            stats.samples++;
+            stats.total += count;
+            stats.max = (count > stats.max) ? count : stats.max;
+        }
+    }
+
+    /** Return the number of open events. */
+    std::size_t NumEvents() const { return counters_.size(); }
+
+    /** Return the \p i th open event. */
+    PerfCounter::Event EventAt(std::size_t i) const {
+        return counters_[i].CountedEvent();
+    }
+
+    /** Return the stats of event \p event in section \p section. */
+    const Stats& At(std::size_t section, std::size_t event) const {
+        return stats_[section][event];
+    }
+
+    /**
+     * Return true if there are open hardware events and all of them are read
+     * with rdpmc.
+     */
+    bool UserReadable() const;
+
+    /** Return a description of each event that couldn't be opened. */
+    const std::vector<std::string>& Skipped() const { return skipped_; }
+
+   private:
+    using Counts = std::array<uint64_t, kMaxEvents>;
+
+    std::vector<PerfCounter> counters_;
+    std::vector<std::string> skipped_;
+    std::array<Counts, kMaxSections> start_;
+    std::array<std::array<Stats, kMaxEvents>, kMaxSections> stats_;
+};
+
+}  // namespace gsync
+
+#endif
@@ -0,0 +1,97 @@
+#ifndef SCHED_H_
+#define SCHED_H_
+
+#include <cstdint>
+#include <string>
+
+namespace gsync {
+namespace sched {
+
+/** Scheduling policy requested by the user. */
+enum class Policy {
+    kInherit,  /**< Keep whatever policy we were started with (e.g., by
+                  chrt). */
+    kFifo,     /**< SCHED_FIFO at a fixed priority. */
+    kDeadline, /**< SCHED_DEADLINE with a runtime/deadline/period budget. */
+};
+
+/** Real-time scheduling configuration. */
+struct Config {
+    Policy policy = Policy::kInherit; /**< Scheduling policy. */
+    int priority = 0;         /**< SCHED_FIFO priority in the range [1, 99]. */
+    uint64_t runtime_ns = 0;  /**< SCHED_DEADLINE runtime budget. */
+    uint64_t deadline_ns = 0; /**< SCHED_DEADLINE relative deadline. */
+    uint64_t period_ns = 0;   /**< SCHED_DEADLINE period. */
+    int cpu = -1;             /**< CPU to pin to, -1 to leave affinity alone. */
+    std::string cpuset;       /**< cgroup directory (e.g., an isolated cpuset
+                                 partition) to move into, empty for none. */
+};
+
+/**
+ * Move the calling process into a cgroup.
+ *
+ * @param[in] cgroup_dir Path to the cgroup directory. Both the cgroup v2
+ * \a cgroup.procs and the cgroup v1 \a tasks interfaces are supported.
+ *
+ * @throws std::runtime_error
+ */
+void MoveToCpuset(const std::string& cgroup_dir);
+
+/**
+ * Pin the calling thread to a single CPU.
+ *
+ * @throws std::runtime_error
+ */
+void SetCpuAffinity(int cpu);
+
+/**
+ * Switch the calling thread to SCHED_FIFO.
+ *
+ * @param[in] priority Priority in the range [1, 99].
+ *
+ * @throws std::runtime_error
+ */
+void SetFifo(int priority);
+
+/**
+ * Switch the calling thread to SCHED_DEADLINE.
+ *
+ * The kernel requires runtime <= deadline <= period. Note, SCHED_DEADLINE
+ * tasks can't be pinned to a CPU subset of their root domain. Use an isolated
+ * cpuset partition instead of SetCpuAffinity() to restrict where they run.
+ *
+ * @throws std::runtime_error
+ */
+void SetDeadline(uint64_t runtime_ns, uint64_t deadline_ns,
+                 uint64_t period_ns);
+
+/**
+ * Return a human readable description of the calling thread's scheduling
+ * policy, e.g., "SCHED_FIFO priority 70".
+ *
+ * @throws std::runtime_error
+ */
+std::string DescribeSched();
+
+/** Return true if the calling thread runs under a real-time policy. */
+bool IsRealTime();
+
+/**
+ * Apply a real-time scheduling configuration to the calling thread.
+ *
+ * The cpuset move is applied first, then the CPU affinity and finally the
+ * scheduling policy. A CPU can't be combined with Policy::kDeadline, see
+ * SetDeadline().
+ *
+ * See the "Scheduling Policies" section of
+ * https://programmador.com/posts/real-time-linux-app-development/
+ * for details.
+ *
+ * @throws std::runtime_error
+ */
+void ConfigureSchedForRt(const Config& config);
+
+}  // namespace sched
+}  // namespace gsync
+
+#endif
@@ -0,0 +1,47 @@
+#ifndef CHANNEL_H_
+#define CHANNEL_H_
+
+#include <time.h>
+
+#include "util/shmem/shmem.hpp"
+
+namespace gsync {
+
+/**
+ * Peer channel over gtimer's shared memory timestamp slot.
+ *
+ * gtimer publishes the capture time of each peer edge and gsync reads the
+ * latest one back. Every access holds the slot's mutex. Neither side throws,
+ * a failure to take the mutex is returned as an error code.
+ */
+class ShMemChannel {
+   public:
+    /**
+     * Construct a channel over an attached shared memory slot.
+     *
+     * @param[in] slot Shared memory slot, see IpShMem::GetData().
+     */
+    explicit ShMemChannel(IpShMemData<struct timespec>* slot) : slot_(slot) {}
+
+    /* The default copy/move constructors and assignment methods will work for
+     * objects of this class. Copies share the slot. */
+    ShMemChannel() = delete;
+    ~ShMemChannel() = default;
+    ShMemChannel(const ShMemChannel&) = default;
+    ShMemChannel& operator=(const ShMemChannel&) = default;
+    ShMemChannel(ShMemChannel&&) = default;
+    ShMemChannel& operator=(ShMemChannel&&) = default;
+
+    /** Return the last published timestamp, zero if there is none yet. */
+    Expected<timespec> Read() { return slot_->Load(); }
+
+    /** Publish timestamp \p ts. */
+    Expected<void> Publish(const timespec& ts) { return slot_->Store(ts); }
+
+   private:
+    IpShMemData<struct timespec>* slot_;
+};
+
+}  // namespace gsync
+
+#endif
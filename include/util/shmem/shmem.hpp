@@ -8,6 +8,8 @@
 #include <stdexcept>
 #include <string>
 
+#include "util/expected/expected.hpp"
+
 namespace gsync {
 
 /**
@@ -17,7 +19,8 @@ namespace gsync {
  * user defined type to be hosted in shared memory. IpShMemData provides an
  * interface for synchronizing access to the data in shared memory using a
  * mutex. The user is responsible for orchestrating sync using the
- * Lock(), TryLock(), and Unlock() methods.
+ * Lock(), TryLock(), and Unlock() methods, or copies the data in and out
+ * under the lock with Load() and Store().
  */
 template <typename T>
 struct IpShMemData {
@@ -44,6 +47,36 @@ struct IpShMemData {
      * @returns See \a man \a pthread_mutex_unlock.
      */
     int Unlock() { return (0 == pthread_mutex_unlock(&lock)); }
+
+    /**
+     * Return a copy of the data taken under the lock.
+     *
+     * @returns The data or the \a pthread_mutex_lock() error.
+     */
+    Expected<T> Load() {
+        int err = pthread_mutex_lock(&lock);
+        if (err) {
+            return ErrnoError(err);
+        }
+        T copy = data;
+        pthread_mutex_unlock(&lock);
+        return copy;
+    }
+
+    /**
+     * Overwrite the data with \p value under the lock.
+     *
+     * @returns Nothing or the \a pthread_mutex_lock() error.
+     */
+    Expected<void> Store(const T& value) {
+        int err = pthread_mutex_lock(&lock);
+        if (err) {
+            return ErrnoError(err);
+        }
+        data = value;
+        pthread_mutex_unlock(&lock);
+        return {};
+    }
 };
 
 /**
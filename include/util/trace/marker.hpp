@@ -0,0 +1,89 @@
+#ifndef MARKER_H_
+#define MARKER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+
+#include "util/expected/expected.hpp"
+
+namespace gsync {
+
+/**
+ * ftrace trace_marker writer.
+ *
+ * Each Mark() writes one line to tracefs' trace_marker file, which the
+ * kernel timestamps and interleaves with every other event in the trace
+ * buffer. A marker reads
+ *
+ *   TAG[PID] EVENT KEY=VALUE KEY=VALUE ...
+ *
+ * e.g., "gsync[312] wake seq=42 t_ns=1234 late_ns=56". The PID tells apart
+ * several instances of a program tracing at once. The file is opened once on
+ * construction. Mark() formats into a fixed size buffer and makes a single
+ * write() system call, it neither allocates nor throws. When no trace is
+ * being recorded, the kernel drops the marker.
+ */
+class TraceMarker {
+   public:
+    /** Longest marker written, longer markers are truncated. */
+    static constexpr std::size_t kMaxLength = 256;
+
+    /** A named integer value carried by a marker. */
+    struct Field {
+        const char* key; /**< Field name, no spaces. */
+        int64_t value;   /**< Field value. */
+    };
+
+    /**
+     * Open trace_marker.
+     *
+     * @param[in] tag Tag every marker starts with, usually the program name.
+     * @param[in] path Path of the trace_marker file. If empty, tracefs is
+     * looked for at /sys/kernel/tracing then /sys/kernel/debug/tracing.
+     *
+     * @throws std::runtime_error If trace_marker can't be opened for writing,
+     * e.g., tracefs isn't mounted or we aren't root.
+     */
+    explicit TraceMarker(const std::string& tag, const std::string& path = "");
+
+    /* No reason to copy or move TraceMarker objects at this time. */
+    TraceMarker() = delete;
+    ~TraceMarker();
+    TraceMarker(const TraceMarker&) = delete;
+    TraceMarker& operator=(const TraceMarker&) = delete;
+    TraceMarker(TraceMarker&&) = delete;
+    TraceMarker& operator=(TraceMarker&&) = delete;
+
+    /**
+     * Write a marker.
+     *
+     * @param[in] event Event name, no spaces.
+     * @param[in] fields Values carried by the marker.
+     *
+     * @returns An error if the write failed.
+     */
+    Expected<void> Mark(const char* event,
+                        std::initializer_list<Field> fields) noexcept;
+
+    /** Return the path of the trace_marker file written to. */
+    const std::string& Path() const { return path_; }
+
+    /** Return the number of markers written. */
+    uint64_t Written() const { return written_; }
+
+    /** Return the number of markers whose write failed. */
+    uint64_t Failed() const { return failed_; }
+
+   private:
+    std::string prefix_;
+    std::string path_;
+    int fd_;
+    uint64_t written_;
+    uint64_t failed_;
+};
+
+}  // namespace gsync
+
+#endif
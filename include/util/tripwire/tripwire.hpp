@@ -0,0 +1,90 @@
+#ifndef TRIPWIRE_H_
+#define TRIPWIRE_H_
+
+#include <cstdint>
+
+namespace gsync {
+namespace tripwire {
+
+/** Real-time violations seen while the tripwire was armed. */
+struct Trips {
+    uint64_t allocations = 0;  /**< Calls into the malloc() family. */
+    uint64_t frees = 0;        /**< Calls to free(). */
+    uint64_t minor_faults = 0; /**< Minor page faults. */
+    uint64_t major_faults = 0; /**< Major page faults. */
+};
+
+#ifdef GSYNC_RT_TRIPWIRE
+
+/** True when the tripwire is compiled in. */
+static constexpr bool kEnabled = true;
+
+/**
+ * Arm the tripwire.
+ *
+ * While armed, every call into the malloc() family (and so every new/delete)
+ * is reported on stderr along with the call stack that made it. In debug
+ * builds, the process is aborted instead so the violation can be inspected in
+ * a core dump or debugger.
+ */
+void Arm();
+
+/**
+ * Disarm the tripwire.
+ *
+ * This function is async-signal-safe so that it may be called from a signal
+ * handler that is about to make the real-time loop exit.
+ */
+void Disarm();
+
+/** Return true if the tripwire is armed. */
+bool Armed();
+
+/**
+ * Check for page faults taken since the last check.
+ *
+ * Page faults can't be trapped as they happen, call this once per loop
+ * iteration instead. Faults are reported with the call stack of the check,
+ * which narrows them down to the iteration that took them.
+ */
+void CheckFaults();
+
+/** Return the violations seen so far. */
+Trips Count();
+
+#else
+
+static constexpr bool kEnabled = false;
+
+inline void Arm() {}
+inline void Disarm() {}
+inline bool Armed() { return false; }
+inline void CheckFaults() {}
+inline Trips Count() { return Trips(); }
+
+#endif
+
+/** Disarm the tripwire for the lifetime of the object, e.g., around code that
+ * may allocate but isn't part of the real-time path. */
+class Pause {
+   public:
+    Pause() : was_armed_(Armed()) { Disarm(); }
+    ~Pause() {
+        if (was_armed_) {
+            Arm();
+        }
+    }
+
+    Pause(const Pause&) = delete;
+    Pause& operator=(const Pause&) = delete;
+    Pause(Pause&&) = delete;
+    Pause& operator=(Pause&&) = delete;
+
+   private:
+    bool was_armed_;
+};
+
+}  // namespace tripwire
+}  // namespace gsync
+
+#endif
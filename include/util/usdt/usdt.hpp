@@ -0,0 +1,111 @@
+#ifndef USDT_H_
+#define USDT_H_
+
+/*
+ * USDT (SystemTap style) static probes.
+ *
+ * GSYNC_PROBEn(name, args...) places probe gsync:name with n integer
+ * arguments, e.g., for bpftrace:
+ *
+ *   bpftrace -e 'usdt:./gsync:gsync:peer_read { printf("%d\n", arg1); }'
+ *
+ * Every probe is guarded by a semaphore, a counter in the .probes section
+ * that a tracer increments while it is attached to the probe. Until then, a
+ * probe costs a load and a not taken branch. Its arguments aren't evaluated.
+ * GSYNC_PROBE_ENABLED(name) tests the semaphore, for sites that compute
+ * something just for the probe. Each probe's semaphore is declared below with
+ * GSYNC_PROBE_SEMAPHORE() and defined in usdt.cc, a new probe needs both.
+ *
+ * The probes are only compiled in with <sys/sdt.h> (systemtap-sdt-dev) and
+ * the GSYNC_USDT CMake option. Otherwise the macros expand to nothing,
+ * arguments included, so keep argument expressions free of side effects.
+ */
+
+#if defined(GSYNC_USDT) && __has_include(<sys/sdt.h>)
+
+/* Have every probe's note record its semaphore's address. */
+#define _SDT_HAS_SEMAPHORES 1
+#include <sys/sdt.h>
+
+namespace gsync {
+namespace usdt {
+/** True when the probes are compiled in. */
+static constexpr bool kEnabled = true;
+}  // namespace usdt
+}  // namespace gsync
+
+/* The semaphore's name and section are fixed by the SystemTap note format. */
+#define GSYNC_PROBE_SEMAPHORE(name)                             \
+    extern "C" volatile unsigned short gsync_##name##_semaphore \
+        __attribute__((section(".probes")))
+
+GSYNC_PROBE_SEMAPHORE(peer_read);
+GSYNC_PROBE_SEMAPHORE(phase_step);
+GSYNC_PROBE_SEMAPHORE(base_rate);
+GSYNC_PROBE_SEMAPHORE(compute_wakeup);
+GSYNC_PROBE_SEMAPHORE(sleep_enter);
+GSYNC_PROBE_SEMAPHORE(sleep_exit);
+GSYNC_PROBE_SEMAPHORE(edge_captured);
+GSYNC_PROBE_SEMAPHORE(publish);
+
+#define GSYNC_PROBE_ENABLED(name) \
+    __builtin_expect(gsync_##name##_semaphore != 0, 0)
+
+#define GSYNC_PROBE0(name)               \
+    do {                                 \
+        if (GSYNC_PROBE_ENABLED(name)) { \
+            DTRACE_PROBE(gsync, name);   \
+        }                                \
+    } while (0)
+#define GSYNC_PROBE1(name, a1)              \
+    do {                                    \
+        if (GSYNC_PROBE_ENABLED(name)) {    \
+            DTRACE_PROBE1(gsync, name, a1); \
+        }                                   \
+    } while (0)
+#define GSYNC_PROBE2(name, a1, a2)              \
+    do {                                        \
+        if (GSYNC_PROBE_ENABLED(name)) {        \
+            DTRACE_PROBE2(gsync, name, a1, a2); \
+        }                                       \
+    } while (0)
+#define GSYNC_PROBE3(name, a1, a2, a3)              \
+    do {                                            \
+        if (GSYNC_PROBE_ENABLED(name)) {            \
+            DTRACE_PROBE3(gsync, name, a1, a2, a3); \
+        }                                           \
+    } while (0)
+
+#else
+
+namespace gsync {
+namespace usdt {
+static constexpr bool kEnabled = false;
+}  // namespace usdt
+}  // namespace gsync
+
+#define GSYNC_PROBE_ENABLED(name) false
+
+/* sizeof() marks the arguments used without evaluating them. */
+#define GSYNC_PROBE0(name) \
+    do {                   \
+    } while (0)
+#define GSYNC_PROBE1(name, a1) \
+    do {                       \
+        (void)sizeof(a1);      \
+    } while (0)
+#define GSYNC_PROBE2(name, a1, a2) \
+    do {                           \
+        (void)sizeof(a1);          \
+        (void)sizeof(a2);          \
+    } while (0)
+#define GSYNC_PROBE3(name, a1, a2, a3) \
+    do {                               \
+        (void)sizeof(a1);              \
+        (void)sizeof(a2);              \
+        (void)sizeof(a3);              \
+    } while (0)
+
+#endif
+
+#endif
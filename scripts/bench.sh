@@ -0,0 +1,14 @@
+#!/bin/bash
+
+# Run the microbenchmarks and save the results as JSON. Copy this script next
+# to the gsync_bench binary to run it on target. The results file is named
+# after the machine architecture so that runs on different boards can be
+# compared side by side, e.g., with Google Benchmark's compare.py. Any
+# arguments are passed on to gsync_bench (e.g., --benchmark_filter=Kuramoto).
+
+BENCH_BIN="./gsync_bench"
+RESULTS_FILE="bench_$(uname -m).json"
+
+$BENCH_BIN --benchmark_out=$RESULTS_FILE \
+           --benchmark_out_format=json \
+           "$@"
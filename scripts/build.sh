@@ -2,6 +2,11 @@
 
 BUILD_TYPE="Release"
 BUILD_DOCS="OFF"
+BUILD_BENCHMARKS="OFF"
+RT_TRIPWIRE="OFF"
+ARM_CNTVCT="OFF"
+SPAN_TIMERS="OFF"
+SPAN_PULSE="OFF"
 TOOLCHAIN_FILE=""
 
 source config.sh
@@ -14,7 +19,12 @@ Help()
     echo "options:"
     echo -e "\tg    enable debug info"
     echo -e "\td    build project docs"
+    echo -e "\tb    build microbenchmarks"
     echo -e "\tc    cross compile for the beaglebone black"
+    echo -e "\tt    trap allocations and page faults in the RT loops"
+    echo -e "\ta    read the ARM generic timer directly on 32-bit ARM"
+    echo -e "\ts    time each section of the gsync loop"
+    echo -e "\tp    with s, time the whole gsync pulse rather than its parts"
     echo -e "\th    print this help message"
 }
 
@@ -26,6 +36,11 @@ Main()
     pushd $GSYNC_BUILD_DIR
         cmake ../ \
               -DBUILD_DOCS=$BUILD_DOCS \
+              -DBUILD_BENCHMARKS=$BUILD_BENCHMARKS \
+              -DGSYNC_RT_TRIPWIRE=$RT_TRIPWIRE \
+              -DGSYNC_ARM_CNTVCT=$ARM_CNTVCT \
+              -DGSYNC_SPAN_TIMERS=$SPAN_TIMERS \
+              -DGSYNC_SPAN_PULSE=$SPAN_PULSE \
               -DCMAKE_EXPORT_COMPILE_COMMANDS=ON \
               -DCMAKE_TOOLCHAIN_FILE=$TOOLCHAIN_FILE \
               -DCMAKE_BUILD_TYPE=$BUILD_TYPE && \
@@ -40,11 +55,16 @@ Main()
     popd
 }
 
-while getopts ":hgcd" flag
+while getopts ":hgcdbtasp" flag
 do
     case "$flag" in
         g) BUILD_TYPE="Debug";;
         d) BUILD_DOCS="ON";;
+        b) BUILD_BENCHMARKS="ON";;
+        t) RT_TRIPWIRE="ON";;
+        a) ARM_CNTVCT="ON";;
+        s) SPAN_TIMERS="ON";;
+        p) SPAN_PULSE="ON";;
         c) TOOLCHAIN_FILE=${GSYNC_PROJECT_PATH}/cmake/arm-linux-gnueabihf-gcc.cmake;;
         h) Help
            exit;;
@@ -0,0 +1,42 @@
+#!/bin/bash
+
+# Measure the one-way GPIO capture latency between two boards. Run this script
+# with the "responder" role on one board and then with the "initiator" role on
+# the other. The initiator saves the latency to $LATENCY_FILE. Swap the roles
+# to calibrate the other board. Stop the responder with kill.sh.
+
+GPIO_DEVNAME="/dev/gpiochip1"
+GPIO_IN_OFFSET=16
+GPIO_OUT_OFFSET=17
+SHMEMKEY=57005
+GTIMER_PRIO=80
+GSYNC_PRIO=70
+GTIMER_CPU=2
+GSYNC_CPU=3
+FREQ_HZ=10
+SAMPLES=100
+LATENCY_FILE="latency.txt"
+
+# Both programs set up their own scheduling policy and CPU affinity, the same
+# way as in run.sh.
+case "$1" in
+    initiator)
+        ./gtimer -P $GTIMER_PRIO -A $GTIMER_CPU \
+                 $GPIO_DEVNAME $GPIO_IN_OFFSET $SHMEMKEY &
+        GTIMER_PID=$!
+
+        ./gsync -P $GSYNC_PRIO -A $GSYNC_CPU \
+                -f $FREQ_HZ -n $SAMPLES -C $LATENCY_FILE \
+                $GPIO_DEVNAME $GPIO_OUT_OFFSET $SHMEMKEY
+
+        kill -SIGINT $GTIMER_PID
+        ;;
+    responder)
+        ./gtimer -P $GTIMER_PRIO -A $GTIMER_CPU -e $GPIO_OUT_OFFSET \
+                 $GPIO_DEVNAME $GPIO_IN_OFFSET $SHMEMKEY &
+        ;;
+    *)
+        echo "usage: calibrate.sh initiator|responder"
+        exit 1
+        ;;
+esac
@@ -8,9 +8,25 @@ GTIMER_PRIO=80
 GSYNC_PRIO=70
 FREQ_HZ=1
 COUPLING_CONST=0.5
+CONTROLLER=kuramoto
+LATENCY_FILE="latency.txt"
+GTIMER_CPU=2
+GSYNC_CPU=3
 
-chrt --fifo $GTIMER_PRIO ./gtimer $GPIO_DEVNAME $GPIO_IN_OFFSET $SHMEMKEY &
+# Use the capture latency measured by calibrate.sh if there is one.
+LATENCY_OPT=""
+if [ -f $LATENCY_FILE ]
+then
+    LATENCY_OPT="-L $LATENCY_FILE"
+fi
 
-chrt --fifo $GSYNC_PRIO \
-    ./gsync -f $FREQ_HZ -k $COUPLING_CONST $GPIO_DEVNAME $GPIO_OUT_OFFSET \
-            $SHMEMKEY &
+# Both programs set up their own scheduling policy and CPU affinity. To run
+# under SCHED_DEADLINE, replace "-P PRIO -A CPU" with "-D RUNTIME_NS". The
+# kernel won't admit a SCHED_DEADLINE task pinned with -A, so isolate it with
+# "-S CPUSET_DIR" naming an exclusive cpuset partition instead.
+./gtimer -P $GTIMER_PRIO -A $GTIMER_CPU -f $FREQ_HZ \
+         $GPIO_DEVNAME $GPIO_IN_OFFSET $SHMEMKEY &
+
+./gsync -P $GSYNC_PRIO -A $GSYNC_CPU \
+        -f $FREQ_HZ -k $COUPLING_CONST -c $CONTROLLER $LATENCY_OPT \
+        $GPIO_DEVNAME $GPIO_OUT_OFFSET $SHMEMKEY &
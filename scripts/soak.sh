@@ -0,0 +1,54 @@
+#!/bin/bash
+
+# Run two gsync/gtimer pairs on this machine, cross wired over a virtual GPIO
+# bus, then stop them and print their telemetry. Run it from the directory
+# holding the binaries. No GPIO hardware or root privileges are needed: both
+# programs only lock the pages they touch and size their prefault off of a
+# warm-up (MEM_OPTS), which fits in the default RLIMIT_MEMLOCK. The virtual
+# lines emulate a capture latency of GSYNC_VGPIO_DELAY_NS plus up to
+# GSYNC_VGPIO_JITTER_NS of jitter.
+
+BUS="soak"
+SHMEMKEY_A=57005
+SHMEMKEY_B=57006
+LINE_A_TO_B=17
+LINE_B_TO_A=16
+FREQ_HZ=${FREQ_HZ:-100}
+CONTROLLER=${CONTROLLER:-kuramoto}
+DURATION_S=${DURATION_S:-10}
+MEM_OPTS=${MEM_OPTS:-"-l onfault -z auto -H auto"}
+LOG_DIR=$(mktemp -d)
+
+export GSYNC_VGPIO_DELAY_NS=${GSYNC_VGPIO_DELAY_NS:-20000}
+export GSYNC_VGPIO_JITTER_NS=${GSYNC_VGPIO_JITTER_NS:-10000}
+
+# Each board listens on the line its peer drives.
+./gtimer -f $FREQ_HZ $MEM_OPTS vgpio:$BUS $LINE_B_TO_A $SHMEMKEY_A \
+    > $LOG_DIR/gtimer_a.log 2>&1 &
+./gtimer -f $FREQ_HZ $MEM_OPTS vgpio:$BUS $LINE_A_TO_B $SHMEMKEY_B \
+    > $LOG_DIR/gtimer_b.log 2>&1 &
+sleep 0.5
+
+./gsync -f $FREQ_HZ -c $CONTROLLER $MEM_OPTS "$@" \
+    vgpio:$BUS $LINE_A_TO_B $SHMEMKEY_A \
+    > $LOG_DIR/gsync_a.log 2>&1 &
+GSYNC_A_PID=$!
+./gsync -f $FREQ_HZ -c $CONTROLLER $MEM_OPTS "$@" \
+    vgpio:$BUS $LINE_B_TO_A $SHMEMKEY_B \
+    > $LOG_DIR/gsync_b.log 2>&1 &
+GSYNC_B_PID=$!
+
+sleep $DURATION_S
+kill -SIGINT $GSYNC_A_PID $GSYNC_B_PID
+wait $GSYNC_A_PID $GSYNC_B_PID
+pkill --signal SIGINT gtimer
+wait
+
+for log in gsync_a gsync_b
+do
+    echo "== $log"
+    cat $LOG_DIR/$log.log
+done
+
+rm -rf $LOG_DIR
+rm -f /dev/shm/gsync_vgpio_$BUS
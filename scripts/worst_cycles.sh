@@ -0,0 +1,85 @@
+#!/bin/bash
+
+# Print the gsync wakeups that came latest in a text trace, each followed by
+# everything else the trace recorded while gsync waited for it. Record the
+# trace with gsync running under -X, e.g.,
+#
+#   trace-cmd record -e sched -e irq ./gsync -X ...
+#   trace-cmd report > trace.txt
+#
+# then run "worst_cycles.sh trace.txt". The output of "perf script" or of
+# /sys/kernel/tracing/trace works too. COUNT wakeups are printed. Each window
+# opens MARGIN_US microseconds before the wakeup was due, but never before
+# gsync went to sleep, and closes when gsync marked the wakeup.
+
+COUNT=${COUNT:-5}
+MARGIN_US=${MARGIN_US:-100}
+TRACE=$1
+
+if [ -z "$TRACE" ]
+then
+    echo "usage: worst_cycles.sh TRACE_FILE"
+    exit 1
+fi
+
+# Pull the trace timestamp (the first SECONDS.FRACTION: on the line) and the
+# marker fields out of every gsync wake marker. Output one line per wakeup:
+# how late it was, which gsync, its cycle and its window.
+AWK_FUNCS='
+function Stamp(line) {
+    if (match(line, /[0-9]+\.[0-9]+:/)) {
+        return substr(line, RSTART, RLENGTH - 1) + 0
+    }
+    return -1
+}
+function Field(line, key) {
+    if (match(line, " " key "=-?[0-9]+")) {
+        return substr(line, RSTART + length(key) + 2, RLENGTH - length(key) - 2)
+    }
+    return ""
+}
+function Tag(line, event) {
+    if (match(line, "gsync\\[[0-9]+\\] " event " ")) {
+        return substr(line, RSTART, RLENGTH - length(event) - 2)
+    }
+    return ""
+}'
+
+WORST=$(awk -v margin_us=$MARGIN_US "$AWK_FUNCS"'
+{
+    tag = Tag($0, "sleep")
+    if (tag != "") {
+        slept[tag, Field($0, "seq")] = Stamp($0)
+        next
+    }
+    tag = Tag($0, "wake")
+    if (tag == "") {
+        next
+    }
+    seq = Field($0, "seq")
+    late_ns = Field($0, "late_ns")
+    end = Stamp($0)
+    start = end - (late_ns / 1e9) - (margin_us / 1e6)
+    if (((tag, seq - 1) in slept) && (slept[tag, seq - 1] > start)) {
+        start = slept[tag, seq - 1]
+    }
+    printf "%d %s %d %.9f %.9f\n", late_ns, tag, seq, start, end
+}' "$TRACE" | sort -k1,1nr | head -n $COUNT)
+
+if [ -z "$WORST" ]
+then
+    echo "error: no gsync wake markers in $TRACE, was gsync run with -X?"
+    exit 1
+fi
+
+echo "$WORST" | while read LATE_NS TAG SEQ START END
+do
+    echo "== $TAG seq=$SEQ late_ns=$LATE_NS"
+    awk -v start=$START -v end=$END "$AWK_FUNCS"'
+    {
+        stamp = Stamp($0)
+        if ((stamp >= start) && (stamp <= end)) {
+            print
+        }
+    }' "$TRACE"
+done
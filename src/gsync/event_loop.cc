@@ -0,0 +1,281 @@
+#include "event_loop.hpp"
+
+#include <iostream>
+#include <optional>
+#include <type_traits>
+
+#include "util/gpio/backend.hpp"
+#include "util/tripwire/tripwire.hpp"
+
+namespace {
+
+/* Estimator, filter and overrun policies that dispatch each call to whichever
+ * alternative their variant holds. They stand in for the concrete policies in
+ * the instrumented event loops, so a new probe or clock costs a handful of
+ * instantiations rather than another copy of the whole cross product. */
+class VariantEstimator {
+   public:
+    explicit VariantEstimator(AnyEstimator& any) : any_(any) {}
+
+    /* No reason to copy or move VariantEstimator objects at this time. */
+    VariantEstimator() = delete;
+    ~VariantEstimator() = default;
+    VariantEstimator(const VariantEstimator&) = delete;
+    VariantEstimator& operator=(const VariantEstimator&) = delete;
+    VariantEstimator(VariantEstimator&&) = delete;
+    VariantEstimator& operator=(VariantEstimator&&) = delete;
+
+    void Reset() {
+        std::visit([](auto& estimator) { estimator.Reset(); }, any_);
+    }
+    timespec Update(const timespec& peer_wakeup) {
+        return std::visit(
+            [&](auto& estimator) { return estimator.Update(peer_wakeup); },
+            any_);
+    }
+
+   private:
+    AnyEstimator& any_;
+};
+
+class VariantFilter {
+   public:
+    explicit VariantFilter(AnyFilter& any) : any_(any) {}
+
+    /* No reason to copy or move VariantFilter objects at this time. */
+    VariantFilter() = delete;
+    ~VariantFilter() = default;
+    VariantFilter(const VariantFilter&) = delete;
+    VariantFilter& operator=(const VariantFilter&) = delete;
+    VariantFilter(VariantFilter&&) = delete;
+    VariantFilter& operator=(VariantFilter&&) = delete;
+
+    void Reset() {
+        std::visit([](auto& filter) { filter.Reset(); }, any_);
+    }
+    std::optional<int64_t> Filter(int64_t phase_err) {
+        return std::visit(
+            [&](auto& filter) { return filter.Filter(phase_err); }, any_);
+    }
+    uint64_t Accepted() const {
+        return std::visit(
+            [](const auto& filter) -> uint64_t { return filter.Accepted(); },
+            any_);
+    }
+
+   private:
+    AnyFilter& any_;
+};
+
+class VariantOverrun {
+   public:
+    explicit VariantOverrun(AnyOverrun& any) : any_(any) {}
+
+    /* No reason to copy or move VariantOverrun objects at this time. */
+    VariantOverrun() = delete;
+    ~VariantOverrun() = default;
+    VariantOverrun(const VariantOverrun&) = delete;
+    VariantOverrun& operator=(const VariantOverrun&) = delete;
+    VariantOverrun(VariantOverrun&&) = delete;
+    VariantOverrun& operator=(VariantOverrun&&) = delete;
+
+    timespec Apply(timespec& wakeup, const timespec& now, int64_t period_ns) {
+        return std::visit(
+            [&](auto& overrun) {
+                return overrun.Apply(wakeup, now, period_ns);
+            },
+            any_);
+    }
+    uint64_t Overruns() const {
+        return std::visit(
+            [](const auto& overrun) -> uint64_t { return overrun.Overruns(); },
+            any_);
+    }
+    uint64_t SkippedPeriods() const {
+        return std::visit(
+            [](const auto& overrun) -> uint64_t {
+                return overrun.SkippedPeriods();
+            },
+            any_);
+    }
+
+   private:
+    AnyOverrun& any_;
+};
+
+}  // namespace
+
+static void PrintSections(const gsync::NullProbe& probe) { (void)probe; }
+
+static void PrintSections(const gsync::MarkerProbe& probe) { (void)probe; }
+
+static void PrintSections(const gsync::PerfProbe& probe) {
+    const gsync::SectionCounters& counters = probe.Counters();
+    for (std::size_t i = 0; i < gsync::kNumLoopSections; ++i) {
+        std::cout << "section "
+                  << gsync::LoopSectionName(static_cast<gsync::LoopSection>(i))
+                  << ": samples=" << counters.At(i, 0).samples;
+        for (std::size_t j = 0; j < counters.NumEvents(); ++j) {
+            const char* name = gsync::PerfCounter::Name(counters.EventAt(j));
+            const gsync::SectionCounters::Stats& stats = counters.At(i, j);
+            std::cout << " " << name << "_mean=" << stats.Mean() << " "
+                      << name << "_max=" << stats.max;
+        }
+        std::cout << std::endl;
+    }
+}
+
+/* Span timers are a NullProbe when compiled out, which has nothing to print.
+ */
+template <typename Spans>
+static void PrintSpans(const Spans& spans) {
+    if constexpr (std::is_same_v<Spans, gsync::SpanProbe>) {
+        for (std::size_t i = 0; i < gsync::kNumLoopSections; ++i) {
+            gsync::LoopSection section = static_cast<gsync::LoopSection>(i);
+            if (!gsync::IsTimedSpan(section)) {
+                continue;
+            }
+            const gsync::LatencyHistogram& span = spans.At(section);
+            std::cout << "span " << gsync::LoopSectionName(section)
+                      << ": samples=" << span.Count()
+                      << " min_ns=" << span.Min()
+                      << " mean_ns=" << span.Mean()
+                      << " p50_ns=" << span.Percentile(0.5)
+                      << " p99_ns=" << span.Percentile(0.99)
+                      << " p999_ns=" << span.Percentile(0.999)
+                      << " max_ns=" << span.Max() << std::endl;
+        }
+    } else {
+        (void)spans;
+    }
+}
+
+template <typename Probe>
+static void PrintTelemetry(const gsync::LoopTelemetry& telemetry,
+                           const AnyOverrun& any_overrun,
+                           const AnyFilter& any_filter, const Probe& probe,
+                           const gsync::LoopSpans& spans) {
+    std::cout << "telemetry: cycles=" << telemetry.cycles
+              << " base_rate=" << telemetry.base_rate_cycles
+              << " tracked=" << telemetry.tracked_cycles
+              << " phase_steps=" << telemetry.phase_steps
+              << " io_errors=" << telemetry.io_errors;
+    std::visit(
+        [](const auto& overrun) {
+            std::cout << " overruns=" << overrun.Overruns()
+                      << " skipped_periods=" << overrun.SkippedPeriods();
+        },
+        any_overrun);
+    std::visit(
+        [](const auto& filter) {
+            std::cout << " filter_accepted=" << filter.Accepted();
+            /* Only a filter that can reject samples counts them. */
+            if constexpr (requires { filter.Rejected(); }) {
+                std::cout << " filter_rejected=" << filter.Rejected();
+            }
+        },
+        any_filter);
+    std::cout << std::endl;
+    PrintSections(probe);
+    PrintSpans(spans);
+}
+
+static void PrintPrefaulted(const gsync::mem::Usage& prefaulted) {
+    std::cout << "auto prefault: stack=" << prefaulted.stack_bytes
+              << " heap=" << prefaulted.heap_bytes << std::endl;
+}
+
+/* Run the event loop until SIGINT, with the bits of housekeeping that aren't
+ * part of the loop proper in between cycles. */
+template <typename Loop, typename Probe>
+static void RunCycles(Loop& loop, const AnyOverrun& any_overrun,
+                      const AnyFilter& any_filter, const Probe& probe,
+                      const gsync::mem::Config& mem_config) {
+    /* Auto sized memory regions are prefaulted once the loop has run long
+     * enough to have hit every code path it takes while acquiring. The
+     * tripwire, if compiled in, is armed right after. */
+    const uint64_t kMemWarmupCycles = 16;
+    const bool kMemAuto = (!mem_config.stack_size || !mem_config.heap_size);
+
+    while (!exit_gtimer) {
+        loop.Cycle();
+
+        if (dump_telemetry) {
+            gsync::tripwire::Pause pause;
+            dump_telemetry = false;
+            PrintTelemetry(loop.Telemetry(), any_overrun, any_filter, probe,
+                           loop.Spans());
+        }
+
+        if (loop.Telemetry().cycles == kMemWarmupCycles) {
+            if (kMemAuto) {
+                /* A failed prefault costs us page faults later on, not the
+                 * sync. Keep running. */
+                gsync::Expected<gsync::mem::Usage> prefaulted =
+                    gsync::mem::TryPrefaultMeasured(mem_config);
+                if (prefaulted) {
+                    PrintPrefaulted(prefaulted.Value());
+                } else {
+                    std::cerr << "warning: auto prefault failed: "
+                              << prefaulted.Error().message() << std::endl;
+                }
+            }
+            gsync::tripwire::Arm();
+        }
+        gsync::tripwire::CheckFaults();
+        loop.Sleep();
+    }
+}
+
+uint64_t RunEventLoop(AnyClock& any_clock, AnyController& any_sync,
+                      AnyEstimator& any_estimator, AnyFilter& any_filter,
+                      AnyProbe& any_probe, gsync::ConcreteBackend line,
+                      AnyOverrun& any_overrun,
+                      gsync::ShMemChannel& channel,
+                      const gsync::LoopConfig& loop_config,
+                      const gsync::mem::Config& mem_config) {
+    auto run = [&](auto& clock, auto& sync, auto& estimator, auto& filter,
+                   auto& overrun, auto& probe, auto& backend) {
+        gsync::SyncLoop loop(clock, sync, estimator, filter, overrun,
+                             loop_config, backend, channel, probe);
+        RunCycles(loop, any_overrun, any_filter, probe, mem_config);
+
+        gsync::tripwire::Disarm();
+        PrintTelemetry(loop.Telemetry(), any_overrun, any_filter, probe,
+                       loop.Spans());
+        return loop.Telemetry().cycles;
+    };
+
+    /* Deployed, uninstrumented: every clock, controller, estimator, filter,
+     * overrun policy and GPIO backend gets a loop of its own, without virtual
+     * calls. */
+    gsync::NullProbe* null_probe = std::get_if<gsync::NullProbe>(&any_probe);
+    if (null_probe) {
+        return std::visit(
+            [&](auto& clock, auto& sync, auto& estimator, auto& filter,
+                auto& overrun, auto* backend) {
+                return run(clock, sync, estimator, filter, overrun,
+                           *null_probe, *backend);
+            },
+            any_clock, any_sync, any_estimator, any_filter, any_overrun,
+            line);
+    }
+
+    /* Instrumented: only the clock and probe are resolved to their concrete
+     * types. The controller and GPIO backend are reached through their
+     * virtual interfaces and the other policies through a visit per call. */
+    gsync::SyncController& sync = std::visit(
+        [](auto& controller) -> gsync::SyncController& { return controller; },
+        any_sync);
+    gsync::GpioBackend& backend = std::visit(
+        [](auto* concrete) -> gsync::GpioBackend& { return *concrete; }, line);
+    VariantEstimator estimator(any_estimator);
+    VariantFilter filter(any_filter);
+    VariantOverrun overrun(any_overrun);
+    return std::visit(
+        [&](auto& clock, auto& probe) {
+            return run(clock, sync, estimator, filter, overrun, probe,
+                       backend);
+        },
+        any_clock, any_probe);
+}
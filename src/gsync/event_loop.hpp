@@ -0,0 +1,73 @@
+#ifndef GSYNC_EVENT_LOOP_H_
+#define GSYNC_EVENT_LOOP_H_
+
+#include <atomic>
+#include <cstdint>
+#include <variant>
+
+#include "sync/clock.hpp"
+#include "sync/estimator.hpp"
+#include "sync/filter.hpp"
+#include "sync/loop.hpp"
+#include "sync/overrun.hpp"
+#include "sync/pll.hpp"
+#include "sync/probe.hpp"
+#include "sync/sync.hpp"
+#include "util/gpio/resolve.hpp"
+#include "util/mem/mem.hpp"
+#include "util/shmem/channel.hpp"
+
+/*
+ * gsync's event loop. event_loop.cc is built with -fno-exceptions: everything
+ * that can fail is set up by main() beforehand and everything the loop calls
+ * reports failure through an error code.
+ */
+
+/** Set by SIGINT to stop the event loop. */
+extern std::atomic_bool exit_gtimer;
+
+/** Set by SIGUSR1 to request a telemetry report. */
+extern std::atomic_bool dump_telemetry;
+
+/* Clocks, controllers, peer estimators, phase error filters, overrun
+ * policies and section probes gsync can run with. Each uninstrumented
+ * combination, times each GPIO backend, gets its own event loop. An
+ * instrumented loop is only specialized on its clock and probe. */
+using AnyClock = std::variant<gsync::MonotonicClock, gsync::CycleClock>;
+using AnyController = std::variant<gsync::KuramotoSync,
+                                   gsync::AdaptiveKuramotoSync, gsync::PllSync>;
+using AnyEstimator = std::variant<gsync::NullEstimator, gsync::PeerEstimator>;
+using AnyFilter =
+    std::variant<gsync::NullFilter, gsync::MedianFilter, gsync::MadFilter>;
+using AnyOverrun = std::variant<gsync::SkipOverrun, gsync::FireOnceOverrun,
+                                gsync::CompressOverrun>;
+using AnyProbe =
+    std::variant<gsync::NullProbe, gsync::PerfProbe, gsync::MarkerProbe>;
+
+/**
+ * Run the event loop instantiated for the given policies until SIGINT, then
+ * print its telemetry.
+ *
+ * @param[in] any_clock Clock.
+ * @param[in] any_sync Wakeup controller.
+ * @param[in] any_estimator Peer wakeup estimator.
+ * @param[in] any_filter Phase error outlier filter.
+ * @param[in] any_probe Section probe. A MarkerProbe marks each wakeup and
+ * sleep in the ftrace buffer.
+ * @param[in] line Line our wakeup edges are sent on.
+ * @param[in] any_overrun Wakeup overrun policy.
+ * @param[in] channel Channel the peer's last reported wakeup is read from.
+ * @param[in] loop_config Loop parameters.
+ * @param[in] mem_config Memory config, for sizing auto prefaulted regions.
+ *
+ * @returns The number of cycles run.
+ */
+uint64_t RunEventLoop(AnyClock& any_clock, AnyController& any_sync,
+                      AnyEstimator& any_estimator, AnyFilter& any_filter,
+                      AnyProbe& any_probe, gsync::ConcreteBackend line,
+                      AnyOverrun& any_overrun,
+                      gsync::ShMemChannel& channel,
+                      const gsync::LoopConfig& loop_config,
+                      const gsync::mem::Config& mem_config);
+
+#endif
@@ -4,20 +4,53 @@
 #include <unistd.h>
 
 #include <atomic>
+#include <cstdlib>
+#include <initializer_list>
 #include <iostream>
+#include <optional>
+#include <string>
+#include <variant>
 
+#include "event_loop.hpp"
+#include "sync/calibration.hpp"
+#include "sync/clock.hpp"
+#include "sync/estimator.hpp"
+#include "sync/filter.hpp"
+#include "sync/overrun.hpp"
+#include "sync/phase.hpp"
+#include "sync/pll.hpp"
+#include "sync/probe.hpp"
+#include "sync/rate.hpp"
 #include "sync/sync.hpp"
 #include "util/gpio/gpio.hpp"
+#include "util/gpio/resolve.hpp"
+#include "util/mem/arena.hpp"
 #include "util/mem/mem.hpp"
+#include "util/perf/perf.hpp"
+#include "util/perf/sections.hpp"
+#include "util/sched/sched.hpp"
+#include "util/shmem/channel.hpp"
 #include "util/shmem/shmem.hpp"
+#include "util/trace/marker.hpp"
+#include "util/tripwire/tripwire.hpp"
 
 /* An atomic_bool used within a signal handler context must be lock free. */
 static_assert(std::atomic<bool>::is_always_lock_free);
 std::atomic_bool exit_gtimer = false;
 
+std::atomic_bool dump_telemetry = false;
+
 static void ExitHandler(int sig) {
     (void)sig; /* Cast to void to avoid unused variable warning. */
     exit_gtimer = true;
+
+    /* Whatever the loop does on its way out isn't on the real-time path. */
+    gsync::tripwire::Disarm();
+}
+
+static void TelemetryHandler(int sig) {
+    (void)sig; /* Cast to void to avoid unused variable warning. */
+    dump_telemetry = true;
 }
 
 static int InitAction(int sig, int flags, void (*handler)(int)) {
@@ -29,68 +62,103 @@ static int InitAction(int sig, int flags, void (*handler)(int)) {
     return sigaction(sig, &action, NULL);
 }
 
-static timespec SetWakeupUsingBaseFreq(timespec& actual_wakeup,
-                                       int frequency_hz) {
-    const int64_t kSecToNano = 1000000000;
-    double dt_nano = (1.0 / frequency_hz) * kSecToNano;
+static void PrintTrips() {
+    if (gsync::tripwire::kEnabled) {
+        const gsync::tripwire::Trips kTrips = gsync::tripwire::Count();
+        std::cout << "tripwire: allocations=" << kTrips.allocations
+                  << " frees=" << kTrips.frees
+                  << " minor_faults=" << kTrips.minor_faults
+                  << " major_faults=" << kTrips.major_faults << std::endl;
+    }
+}
 
-    /* Add the wakeup delta based on the base frequency. */
-    timespec new_wakeup = {
-        .tv_sec = actual_wakeup.tv_sec,
-        .tv_nsec = actual_wakeup.tv_nsec + static_cast<long>(dt_nano),
-    };
+static void PrintTlbMisses(uint64_t misses, uint64_t cycles) {
+    std::cout << "dtlb_read_misses: total=" << misses << " per_cycle="
+              << (cycles ? (static_cast<double>(misses) /
+                            static_cast<double>(cycles))
+                         : 0.0)
+              << std::endl;
+}
 
-    /* Normalize the timespec. */
-    while (new_wakeup.tv_nsec >= kSecToNano) {
-        new_wakeup.tv_sec++;
-        new_wakeup.tv_nsec -= kSecToNano;
-    }
-    return new_wakeup;
+static void PrintCycleClock(const gsync::CycleClock& clock) {
+    std::cout << "cycle clock: frequency_hz=" << clock.FrequencyHz()
+              << " recalibrations=" << clock.Recalibrations()
+              << " last_offset_ns=" << clock.LastOffsetNs() << std::endl;
 }
 
-static void RunEventLoop(const gsync::KuramotoSync& sync,
-                         gsync::Gpio& runtime_gpio,
-                         gsync::IpShMemData<struct timespec>* peer_runtime) {
-    auto TsEqual = [](const timespec& a, const timespec& b) {
-        return ((a.tv_sec == b.tv_sec) && (a.tv_nsec == b.tv_nsec));
+/* Estimate the one-way capture latency. Our peer must be running gtimer in
+ * echo mode so that each of our edges bounces straight back to our gtimer.
+ * The round trip runs from our GPIO write to the timestamp our gtimer
+ * records, exactly the path a peer wakeup takes in the event loop. */
+static int64_t RunCalibration(
+    gsync::SyncRate rate, int samples, gsync::mem::LockedArena& arena,
+    gsync::Gpio& runtime_gpio,
+    gsync::IpShMemData<struct timespec>* peer_runtime) {
+    const int64_t kPeriodNano = rate.NominalPeriod();
+    const timespec kPollInterval = {.tv_sec = 0, .tv_nsec = 50000};
+
+    auto ReadPeer = [peer_runtime]() {
+        peer_runtime->Lock();
+        timespec ts = peer_runtime->data;
+        peer_runtime->Unlock();
+        return ts;
     };
 
-    timespec empty_ts = {.tv_sec = 0, .tv_nsec = 0};
-    timespec actual_wakeup = {};
-    timespec peer_wakeup = {};
-    timespec new_wakeup = {};
-    timespec prev_peer_wakeup = {};
+    gsync::LatencyCalibration calibration(static_cast<std::size_t>(samples),
+                                          &arena);
+    timespec start = {};
+    timespec now = {};
+    timespec next_cycle = {};
+    int lost = 0;
+    clock_gettime(CLOCK_MONOTONIC, &next_cycle);
+    for (int i = 0; (i < samples) && !exit_gtimer; ++i) {
+        int64_t prev_echo = gsync::TsToNano(ReadPeer());
 
-    while (!exit_gtimer) {
-        /* Send wakeup signal to our peer. */
         runtime_gpio.Val(gsync::Gpio::Value::kHigh);
+        clock_gettime(CLOCK_MONOTONIC, &start);
 
-        /* Record our true wakeup time. */
-        clock_gettime(CLOCK_MONOTONIC, &actual_wakeup);
-
-        /* Record our peer's last reported wakeup time. */
-        peer_runtime->Lock();
-        peer_wakeup = peer_runtime->data;
-        peer_runtime->Unlock();
+        /* Wait up to half a period for the echo to show up in shmem. */
+        int64_t echo = prev_echo;
+        do {
+            clock_nanosleep(CLOCK_MONOTONIC, 0, &kPollInterval, NULL);
+            echo = gsync::TsToNano(ReadPeer());
+            clock_gettime(CLOCK_MONOTONIC, &now);
+        } while ((echo == prev_echo) &&
+                 ((gsync::TsToNano(now) - gsync::TsToNano(start)) <
+                  (kPeriodNano / 2)));
+        runtime_gpio.Val(gsync::Gpio::Value::kLow);
 
-        if (TsEqual(empty_ts, peer_wakeup) ||
-            TsEqual(prev_peer_wakeup, peer_wakeup)) {
-            /* Our peer is offline or not reporting for some other reason.
-             * Schedule wakeup using the base frequency. */
-            new_wakeup =
-                SetWakeupUsingBaseFreq(actual_wakeup, sync.Frequency());
-        } else {
-            /* Compute a new wakeup time that will keep us in sync with our
-             * peer. */
-            new_wakeup = sync.ComputeNewWakeup(actual_wakeup, peer_wakeup);
+        if ((echo == prev_echo) ||
+            !calibration.AddRoundTrip(echo - gsync::TsToNano(start))) {
+            lost++;
         }
-        prev_peer_wakeup = peer_wakeup;
 
-        /* Bring down the GPIO line as we wrap up this run. */
-        runtime_gpio.Val(gsync::Gpio::Value::kLow);
+        next_cycle =
+            gsync::NanoToTs(gsync::TsToNano(next_cycle) + rate.NextPeriod());
+        gsync::SleepUntilMonotonic(next_cycle, &exit_gtimer);
+    }
 
-        /* Sleep until our next cycle. */
-        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &new_wakeup, NULL);
+    gsync::LatencyCalibration::Stats stats = calibration.RoundTripStats();
+    std::cout << "round trip (ns): count=" << stats.count << " lost=" << lost
+              << " min=" << stats.min << " max=" << stats.max
+              << " median=" << stats.median << " mean=" << stats.mean
+              << " stddev=" << stats.stddev << std::endl;
+    std::cout << "one-way latency (ns): " << calibration.OneWayLatency()
+              << std::endl;
+
+    return calibration.OneWayLatency();
+}
+
+static void PrintCouplingTrajectory(const gsync::AdaptiveCoupling& adaptive) {
+    std::cout << "adaptive coupling trajectory ("
+              << adaptive.Reacquisitions() << " reacquisitions):" << std::endl;
+    for (std::size_t i = 0; i < adaptive.TrajectoryLen(); ++i) {
+        const gsync::AdaptiveCoupling::Sample& sample =
+            adaptive.TrajectoryAt(i);
+        std::cout << "\tcycle=" << sample.cycle << " k=" << sample.k
+                  << " err_mean=" << sample.error_mean
+                  << " err_stddev=" << sample.error_stddev
+                  << ((sample.reacquire) ? " reacquire" : "") << std::endl;
     }
 }
 
@@ -98,10 +166,90 @@ static void PrintUsage() {
     std::cout << "usage: gsync [OPTION]... GPIO_DEVNAME GPIO_OFFSET SHMEM_KEY"
               << std::endl;
     std::cout << "GPIO Based Synchronizer" << std::endl;
-    std::cout << "\t-f, --frequency\t\tspecify sync task frequency in Hz"
+    std::cout << "\t-f, --frequency\t\tspecify sync task frequency in Hz as "
+                 "an integer, decimal or fraction (e.g., 30000/1001)"
+              << std::endl;
+    std::cout << "\t-T, --period-ns\t\tspecify sync task period in "
+                 "nanoseconds"
               << std::endl;
     std::cout << "\t-k, --coupling-const\tspecify Kuramoto coupling constant"
               << std::endl;
+    std::cout << "\t-a, --adaptive\t\tadapt the coupling constant, starting "
+                 "at the given value and decaying towards -k, kuramoto only"
+              << std::endl;
+    std::cout << "\t-c, --controller\tspecify sync controller: kuramoto "
+                 "(default) or pll"
+              << std::endl;
+    std::cout << "\t-p, --kp\t\tspecify PLL proportional gain" << std::endl;
+    std::cout << "\t-i, --ki\t\tspecify PLL integral gain" << std::endl;
+    std::cout << "\t-e, --estimator\t\tfilter peer wakeups with a Kalman "
+                 "phase/period estimator"
+              << std::endl;
+    std::cout << "\t-j, --est-jitter\tspecify estimator peer jitter in ns"
+              << std::endl;
+    std::cout << "\t-r, --reject\t\tspecify peer phase error outlier "
+                 "filter: none (default), median or mad"
+              << std::endl;
+    std::cout << "\t-w, --window\t\tspecify outlier filter window size"
+              << std::endl;
+    std::cout << "\t-t, --mad-threshold\tspecify MAD gate width in "
+                 "standard deviations"
+              << std::endl;
+    std::cout << "\t-C, --calibrate\t\tmeasure the capture latency against "
+                 "a peer running 'gtimer -e' and save it to the given file"
+              << std::endl;
+    std::cout << "\t-n, --samples\t\tspecify number of calibration round "
+                 "trips"
+              << std::endl;
+    std::cout << "\t-L, --latency-file\tcorrect peer wakeups using the "
+                 "latency saved in the given file"
+              << std::endl;
+    std::cout << "\t-o, --overrun\t\tspecify overrun policy: skip "
+                 "(default), fire-once or compress"
+              << std::endl;
+    std::cout << "\t-m, --max-compression\tspecify largest fraction a "
+                 "period may be shortened by when compressing"
+              << std::endl;
+    std::cout << "\t-s, --max-step\t\tspecify the largest phase step, in "
+                 "periods, taken when acquiring a peer"
+              << std::endl;
+    std::cout << "\t-P, --fifo\t\trun under SCHED_FIFO at the given "
+                 "priority"
+              << std::endl;
+    std::cout << "\t-D, --dl-runtime\trun under SCHED_DEADLINE with the "
+                 "given runtime in ns, the deadline and period are the sync "
+                 "period"
+              << std::endl;
+    std::cout << "\t-A, --cpu\t\tpin to the given CPU, not with -D"
+              << std::endl;
+    std::cout << "\t-S, --cpuset\t\tmove into the given cgroup directory"
+              << std::endl;
+    std::cout << "\t-z, --stack-size\tspecify stack bytes to prefault, "
+                 "e.g. 512K, or auto to size off of a warm-up"
+              << std::endl;
+    std::cout << "\t-H, --heap-size\t\tspecify heap bytes to prefault, "
+                 "e.g. 8M, or auto to size off of a warm-up"
+              << std::endl;
+    std::cout << "\t-R, --arena-size\tspecify size of the locked arena "
+                 "calibration samples are allocated from, with -C"
+              << std::endl;
+    std::cout << "\t-l, --lock\t\tspecify memory lock policy: all "
+                 "(default), onfault or regions"
+              << std::endl;
+    std::cout << "\t-g, --huge-pages\tback the arena with huge pages: none "
+                 "(default), thp or explicit, with -C"
+              << std::endl;
+    std::cout << "\t-M, --pmu\t\tcount cycles, instructions, cache and "
+                 "branch misses and context switches in each section of the "
+                 "loop"
+              << std::endl;
+    std::cout << "\t-K, --clock\t\tspecify the loop's clock: monotonic "
+                 "(default) or cycles, the cycle counter calibrated against "
+                 "CLOCK_MONOTONIC"
+              << std::endl;
+    std::cout << "\t-X, --trace-marker\tmark each wakeup and sleep in the "
+                 "ftrace buffer through trace_marker, not with -M"
+              << std::endl;
     std::cout << "\t-h, --help\t\tprint this help page" << std::endl;
     std::cout << "\tGPIO_DEVNAME\t\tspecify input gpio device name"
               << std::endl;
@@ -112,26 +260,98 @@ static void PrintUsage() {
 int main(int argc, char** argv) {
     const int kDefaultFreqHz = 100;
     const double kDefaultCouplingConst = 0.5;
+    const double kDefaultKp = 0.25;
+    const double kDefaultKi = 0.02;
+    const double kDefaultEstJitterNs = 20000.0;
+    const double kDefaultMaxStep = 0.5;
+    const int kDefaultFilterWindow = 5;
+    const double kDefaultMadThreshold = 3.0;
+    const int kDefaultCalibrationSamples = 100;
+    const double kDefaultMaxCompression = 0.25;
+    const std::size_t kDefaultArenaSize = 256 * 1024;
 
     struct option long_options[] = {
         {"frequency", required_argument, 0, 'f'},
+        {"period-ns", required_argument, 0, 'T'},
         {"coupling-const", required_argument, 0, 'k'},
+        {"adaptive", required_argument, 0, 'a'},
+        {"controller", required_argument, 0, 'c'},
+        {"kp", required_argument, 0, 'p'},
+        {"ki", required_argument, 0, 'i'},
+        {"estimator", no_argument, 0, 'e'},
+        {"est-jitter", required_argument, 0, 'j'},
+        {"max-step", required_argument, 0, 's'},
+        {"reject", required_argument, 0, 'r'},
+        {"window", required_argument, 0, 'w'},
+        {"mad-threshold", required_argument, 0, 't'},
+        {"calibrate", required_argument, 0, 'C'},
+        {"samples", required_argument, 0, 'n'},
+        {"latency-file", required_argument, 0, 'L'},
+        {"overrun", required_argument, 0, 'o'},
+        {"max-compression", required_argument, 0, 'm'},
+        {"fifo", required_argument, 0, 'P'},
+        {"dl-runtime", required_argument, 0, 'D'},
+        {"cpu", required_argument, 0, 'A'},
+        {"cpuset", required_argument, 0, 'S'},
+        {"stack-size", required_argument, 0, 'z'},
+        {"heap-size", required_argument, 0, 'H'},
+        {"arena-size", required_argument, 0, 'R'},
+        {"lock", required_argument, 0, 'l'},
+        {"huge-pages", required_argument, 0, 'g'},
+        {"clock", required_argument, 0, 'K'},
+        {"pmu", no_argument, 0, 'M'},
+        {"trace-marker", no_argument, 0, 'X'},
         {"help", no_argument, 0, 'h'},
         {0, 0, 0, 0},
     };
     int opt = '\0';
     int long_index = 0;
-    int frequency_hz = kDefaultFreqHz;
+    gsync::SyncRate rate = gsync::SyncRate::FromHz(kDefaultFreqHz);
     double coupling_const = kDefaultCouplingConst;
-    while (-1 != (opt = getopt_long(argc, argv, "hf:k:",
+    double coupling_const_max = 0.0;
+    std::string controller = "kuramoto";
+    double kp = kDefaultKp;
+    double ki = kDefaultKi;
+    bool use_estimator = false;
+    double est_jitter_ns = kDefaultEstJitterNs;
+    double max_step = kDefaultMaxStep;
+    std::string filter = "none";
+    int filter_window = kDefaultFilterWindow;
+    double mad_threshold = kDefaultMadThreshold;
+    std::string calibration_file;
+    int calibration_samples = kDefaultCalibrationSamples;
+    std::string latency_file;
+    std::string overrun_policy = "skip";
+    double max_compression = kDefaultMaxCompression;
+    gsync::sched::Config sched_config;
+    gsync::mem::Config mem_config;
+    std::size_t arena_size = kDefaultArenaSize;
+    gsync::mem::LockedArena::HugePages arena_huge_pages =
+        gsync::mem::LockedArena::HugePages::kNone;
+    std::string clock_source = "monotonic";
+    bool use_pmu = false;
+    bool use_trace_marker = false;
+    const char* kShortOptions =
+        "hf:T:k:a:c:p:i:ej:s:r:w:t:C:n:L:o:m:P:D:A:S:z:H:R:l:g:K:MX";
+    while (-1 != (opt = getopt_long(argc, argv, kShortOptions,
                                     static_cast<struct option*>(long_options),
                                     &long_index))) {
         switch (opt) {
             case 'f':
                 try {
-                    frequency_hz = std::stoi(optarg);
-                } catch (const std::logic_error& e) {
-                    std::cerr << "error: frequency must be a postive integer"
+                    rate = gsync::SyncRate::Parse(optarg);
+                } catch (const std::runtime_error& e) {
+                    std::cerr << "error: frequency must be a postive integer, "
+                                 "decimal or fraction"
+                              << std::endl;
+                    return 1;
+                }
+                break;
+            case 'T':
+                try {
+                    rate = gsync::SyncRate::FromPeriodNs(std::stoll(optarg));
+                } catch (const std::exception& e) {
+                    std::cerr << "error: period must be a postive integer"
                               << std::endl;
                     return 1;
                 }
@@ -146,6 +366,237 @@ int main(int argc, char** argv) {
                     return 1;
                 }
                 break;
+            case 'a':
+                try {
+                    coupling_const_max = std::stod(optarg);
+                } catch (const std::logic_error& e) {
+                    coupling_const_max = 0.0;
+                }
+                if (coupling_const_max <= 0.0) {
+                    std::cerr << "error: adaptive coupling constant must be a "
+                                 "postive floating point"
+                              << std::endl;
+                    return 1;
+                }
+                break;
+            case 'c':
+                controller = optarg;
+                if (controller != "kuramoto" && controller != "pll") {
+                    std::cerr << "error: controller must be one of kuramoto "
+                                 "or pll"
+                              << std::endl;
+                    return 1;
+                }
+                break;
+            case 'p':
+                try {
+                    kp = std::stod(optarg);
+                } catch (const std::logic_error& e) {
+                    std::cerr << "error: kp must be a floating point"
+                              << std::endl;
+                    return 1;
+                }
+                break;
+            case 'i':
+                try {
+                    ki = std::stod(optarg);
+                } catch (const std::logic_error& e) {
+                    std::cerr << "error: ki must be a floating point"
+                              << std::endl;
+                    return 1;
+                }
+                break;
+            case 'e':
+                use_estimator = true;
+                break;
+            case 'j':
+                try {
+                    est_jitter_ns = std::stod(optarg);
+                } catch (const std::logic_error& e) {
+                    std::cerr << "error: estimator jitter must be a positive "
+                                 "floating point"
+                              << std::endl;
+                    return 1;
+                }
+                break;
+            case 's':
+                try {
+                    max_step = std::stod(optarg);
+                } catch (const std::logic_error& e) {
+                    std::cerr << "error: max step must be a floating point in "
+                                 "the range [0, 0.5]"
+                              << std::endl;
+                    return 1;
+                }
+                if (max_step < 0.0 || max_step > kDefaultMaxStep) {
+                    std::cerr << "error: max step must be a floating point in "
+                                 "the range [0, 0.5]"
+                              << std::endl;
+                    return 1;
+                }
+                break;
+            case 'r':
+                filter = optarg;
+                if (filter != "none" && filter != "median" && filter != "mad") {
+                    std::cerr << "error: outlier filter must be one of none, "
+                                 "median or mad"
+                              << std::endl;
+                    return 1;
+                }
+                break;
+            case 'w':
+                try {
+                    filter_window = std::stoi(optarg);
+                } catch (const std::logic_error& e) {
+                    std::cerr << "error: filter window must be a postive "
+                                 "integer"
+                              << std::endl;
+                    return 1;
+                }
+                break;
+            case 't':
+                try {
+                    mad_threshold = std::stod(optarg);
+                } catch (const std::logic_error& e) {
+                    std::cerr << "error: MAD threshold must be a postive "
+                                 "floating point"
+                              << std::endl;
+                    return 1;
+                }
+                break;
+            case 'C':
+                calibration_file = optarg;
+                break;
+            case 'n':
+                try {
+                    calibration_samples = std::stoi(optarg);
+                } catch (const std::logic_error& e) {
+                    std::cerr << "error: samples must be a postive integer"
+                              << std::endl;
+                    return 1;
+                }
+                break;
+            case 'L':
+                latency_file = optarg;
+                break;
+            case 'o':
+                overrun_policy = optarg;
+                if (overrun_policy != "skip" && overrun_policy != "fire-once" &&
+                    overrun_policy != "compress") {
+                    std::cerr << "error: overrun policy must be one of skip, "
+                                 "fire-once or compress"
+                              << std::endl;
+                    return 1;
+                }
+                break;
+            case 'm':
+                try {
+                    max_compression = std::stod(optarg);
+                } catch (const std::logic_error& e) {
+                    std::cerr << "error: max compression must be a floating "
+                                 "point in the range (0, 1)"
+                              << std::endl;
+                    return 1;
+                }
+                break;
+            case 'P':
+                try {
+                    sched_config.policy = gsync::sched::Policy::kFifo;
+                    sched_config.priority = std::stoi(optarg);
+                } catch (const std::logic_error& e) {
+                    std::cerr << "error: fifo priority must be an integer in "
+                                 "the range [1, 99]"
+                              << std::endl;
+                    return 1;
+                }
+                break;
+            case 'D':
+                try {
+                    sched_config.policy = gsync::sched::Policy::kDeadline;
+                    sched_config.runtime_ns = std::stoull(optarg);
+                } catch (const std::logic_error& e) {
+                    std::cerr << "error: deadline runtime must be a positive "
+                                 "integer"
+                              << std::endl;
+                    return 1;
+                }
+                break;
+            case 'A':
+                try {
+                    sched_config.cpu = std::stoi(optarg);
+                } catch (const std::logic_error& e) {
+                    std::cerr << "error: cpu must be a non-negative integer"
+                              << std::endl;
+                    return 1;
+                }
+                break;
+            case 'S':
+                sched_config.cpuset = optarg;
+                break;
+            case 'z':
+            case 'H':
+                try {
+                    std::optional<std::size_t>& size =
+                        (opt == 'z') ? mem_config.stack_size
+                                     : mem_config.heap_size;
+                    if (std::string(optarg) == "auto") {
+                        size.reset();
+                    } else {
+                        size = gsync::mem::ParseSize(optarg);
+                    }
+                } catch (const std::runtime_error& e) {
+                    std::cerr << "error: " << e.what() << std::endl;
+                    return 1;
+                }
+                break;
+            case 'R':
+                try {
+                    arena_size = gsync::mem::ParseSize(optarg);
+                } catch (const std::runtime_error& e) {
+                    std::cerr << "error: " << e.what() << std::endl;
+                    return 1;
+                }
+                break;
+            case 'l':
+                try {
+                    mem_config.lock = gsync::mem::ParseLockPolicy(optarg);
+                } catch (const std::runtime_error& e) {
+                    std::cerr << "error: " << e.what() << std::endl;
+                    return 1;
+                }
+                break;
+            case 'g':
+                if (std::string(optarg) == "none") {
+                    arena_huge_pages =
+                        gsync::mem::LockedArena::HugePages::kNone;
+                } else if (std::string(optarg) == "thp") {
+                    arena_huge_pages =
+                        gsync::mem::LockedArena::HugePages::kTransparent;
+                } else if (std::string(optarg) == "explicit") {
+                    arena_huge_pages =
+                        gsync::mem::LockedArena::HugePages::kExplicit;
+                } else {
+                    std::cerr << "error: huge pages must be one of none, thp "
+                                 "or explicit"
+                              << std::endl;
+                    return 1;
+                }
+                break;
+            case 'K':
+                clock_source = optarg;
+                if (clock_source != "monotonic" && clock_source != "cycles") {
+                    std::cerr << "error: clock must be one of monotonic or "
+                                 "cycles"
+                              << std::endl;
+                    return 1;
+                }
+                break;
+            case 'M':
+                use_pmu = true;
+                break;
+            case 'X':
+                use_trace_marker = true;
+                break;
             case 'h':
                 PrintUsage();
                 return 0;
@@ -153,6 +604,31 @@ int main(int argc, char** argv) {
                 return 1;
         }
     }
+    if ((coupling_const_max > 0.0) && (controller != "kuramoto")) {
+        std::cerr << "error: adaptive coupling constant only applies to the "
+                     "kuramoto controller"
+                  << std::endl;
+        return 1;
+    }
+    if ((coupling_const_max > 0.0) && (coupling_const_max < coupling_const)) {
+        std::cerr << "error: adaptive coupling constant must not be less than "
+                     "the coupling constant"
+                  << std::endl;
+        return 1;
+    }
+    if ((sched_config.cpu >= 0) &&
+        (sched_config.policy == gsync::sched::Policy::kDeadline)) {
+        std::cerr << "error: SCHED_DEADLINE tasks can't be pinned with -A, "
+                     "use -S with an exclusive cpuset instead"
+                  << std::endl;
+        return 1;
+    }
+    if (use_pmu && use_trace_marker) {
+        std::cerr << "error: -M and -X can't be used together, the wake "
+                     "marker would be counted in the pulse section"
+                  << std::endl;
+        return 1;
+    }
     if (!argv[optind]) {
         std::cerr << "error: missing GPIO_DEVNAME" << std::endl;
         return 1;
@@ -172,10 +648,29 @@ int main(int argc, char** argv) {
         return 1;
     }
 
+    /* Use the SIGUSR1 signal to request a telemetry report. */
+    if (-1 == InitAction(SIGUSR1, 0, TelemetryHandler)) {
+        perror("failed to register SIGUSR1 handler");
+        return 1;
+    }
+
     try {
         /* See https://programmador.com/posts/real-time-linux-app-development/
          */
-        gsync::mem::ConfigureMemForRt();
+        gsync::mem::ConfigureMemForRt(mem_config);
+
+        /* The deadline is the wakeup period, the runtime is the CPU time
+         * budget within each period. */
+        sched_config.deadline_ns =
+            static_cast<uint64_t>(rate.NominalPeriod());
+        sched_config.period_ns = sched_config.deadline_ns;
+        gsync::sched::ConfigureSchedForRt(sched_config);
+        std::cout << "scheduling: " << gsync::sched::DescribeSched()
+                  << std::endl;
+        if (!gsync::sched::IsRealTime()) {
+            std::cerr << "warning: not running under a real-time policy"
+                      << std::endl;
+        }
 
         /* Attach to shared memory allocated by the gtimer process. */
         gsync::IpShMem<struct timespec> shmem_ctrl(std::stoi(argv[optind + 2]));
@@ -187,10 +682,163 @@ int main(int argc, char** argv) {
         runtime_gpio.Dir(gsync::Gpio::Direction::kOutput);
         runtime_gpio.Val(gsync::Gpio::Value::kLow);
 
+        /* In calibration mode, measure and save the latency correction then
+         * exit. */
+        if (!calibration_file.empty()) {
+            if (calibration_samples <= 0) {
+                throw std::runtime_error("samples must be positive");
+            }
+            /* The round trip samples are allocated from a locked arena so
+             * that the calibration loop never has to enter malloc(). The
+             * event loop allocates nothing, it gets no arena. */
+            gsync::mem::LockedArena arena(
+                arena_size, gsync::mem::LockedArena::Strategy::kPool,
+                arena_huge_pages);
+            int64_t latency_ns =
+                RunCalibration(rate, calibration_samples, arena,
+                               runtime_gpio, peer_runtime);
+            gsync::SaveLatency(calibration_file, latency_ns);
+            std::cout << "arena: capacity=" << arena.Capacity()
+                      << " in_use=" << arena.BytesInUse()
+                      << " peak_in_use=" << arena.PeakBytesInUse()
+                      << std::endl;
+            return 0;
+        }
+
+        /* Load the latency correction from a previous calibration run. */
+        int64_t latency_ns = 0;
+        if (!latency_file.empty()) {
+            latency_ns = gsync::LoadLatency(latency_file);
+        }
+
         /* Construct the synchronous wakeup 'calculator'. */
-        gsync::KuramotoSync sync(frequency_hz, coupling_const);
+        AnyController any_sync = [&]() -> AnyController {
+            if (controller == "pll") {
+                return gsync::PllSync(rate, kp, ki);
+            }
+            if (coupling_const_max > 0.0) {
+                /* Acquire with a strong coupling then relax towards -k. */
+                const double kAdaptiveDecay = 0.98;
+                return gsync::AdaptiveKuramotoSync(
+                    rate, gsync::AdaptiveCoupling::Config{
+                              .k_min = coupling_const,
+                              .k_max = coupling_const_max,
+                              .decay = kAdaptiveDecay,
+                          });
+            }
+            return gsync::KuramotoSync(rate, coupling_const);
+        }();
+
+        /* Optionally filter the peer's wakeup samples. The process noise
+         * defaults are scaled off of the expected measurement jitter: the
+         * peer's own controller moves its phase by a fraction of the jitter
+         * each cycle and its oscillator wanders far slower than that. */
+        AnyEstimator any_estimator;
+        if (use_estimator) {
+            any_estimator.emplace<gsync::PeerEstimator>(
+                rate, gsync::PeerEstimator::Config{
+                          .measurement_noise_ns = est_jitter_ns,
+                          .phase_noise_ns = est_jitter_ns / 10.0,
+                          .period_noise_ns = est_jitter_ns / 1000.0,
+                      });
+        }
+
+        /* Reject or smooth out peer phase error outliers. */
+        if (filter_window <= 0) {
+            throw std::runtime_error("filter window must be positive");
+        }
+        AnyFilter any_filter;
+        if (filter == "median") {
+            any_filter.emplace<gsync::MedianFilter>(
+                static_cast<std::size_t>(filter_window));
+        } else if (filter == "mad") {
+            any_filter.emplace<gsync::MadFilter>(
+                static_cast<std::size_t>(filter_window), mad_threshold);
+        }
+
+        /* Recover from wakeups that land in the past. */
+        AnyOverrun any_overrun;
+        if (overrun_policy == "fire-once") {
+            any_overrun.emplace<gsync::FireOnceOverrun>();
+        } else if (overrun_policy == "compress") {
+            any_overrun.emplace<gsync::CompressOverrun>(max_compression);
+        }
+
+        std::cout << "memory: locked=" << gsync::mem::LockedBytes()
+                  << " resident=" << gsync::mem::ResidentBytes() << std::endl;
+
+        /* Count the TLB misses taken by the loop, if the PMU lets us. */
+        std::optional<gsync::PerfCounter> dtlb_misses;
+        try {
+            dtlb_misses.emplace(gsync::PerfCounter::Event::kDtlbReadMisses);
+            dtlb_misses->Enable();
+        } catch (const std::runtime_error& e) {
+            std::cerr << "warning: " << e.what() << std::endl;
+        }
 
-        RunEventLoop(sync, runtime_gpio, peer_runtime);
+        /* Resolve every policy to its concrete type here, once, and run the
+         * event loop instantiated for that combination. */
+        AnyClock any_clock(std::in_place_type<gsync::MonotonicClock>,
+                           &exit_gtimer);
+        if (clock_source == "cycles") {
+            any_clock.emplace<gsync::CycleClock>(
+                gsync::CycleClock::kDefaultRecalibrationNs, &exit_gtimer);
+        }
+        std::optional<gsync::SectionCounters> section_counters;
+        AnyProbe any_probe;
+        if (use_pmu) {
+            section_counters.emplace(
+                std::initializer_list<gsync::PerfCounter::Event>{
+                    gsync::PerfCounter::Event::kCycles,
+                    gsync::PerfCounter::Event::kInstructions,
+                    gsync::PerfCounter::Event::kCacheMisses,
+                    gsync::PerfCounter::Event::kBranchMisses,
+                    gsync::PerfCounter::Event::kContextSwitches,
+                });
+            for (const std::string& skipped : section_counters->Skipped()) {
+                std::cerr << "warning: " << skipped << std::endl;
+            }
+            std::cout << "pmu: rdpmc="
+                      << ((section_counters->UserReadable()) ? "yes" : "no")
+                      << std::endl;
+            any_probe.emplace<gsync::PerfProbe>(*section_counters);
+        }
+        std::optional<gsync::TraceMarker> marker;
+        if (use_trace_marker) {
+            marker.emplace("gsync");
+            std::cout << "trace: marker=" << marker->Path() << std::endl;
+            any_probe.emplace<gsync::MarkerProbe>(*marker);
+        }
+        gsync::ShMemChannel channel(peer_runtime);
+        const gsync::LoopConfig kLoopConfig = {
+            .max_step = max_step,
+            .latency_ns = latency_ns,
+        };
+        uint64_t cycles = RunEventLoop(
+            any_clock, any_sync, any_estimator, any_filter, any_probe,
+            gsync::ResolveBackend(runtime_gpio), any_overrun, channel,
+            kLoopConfig, mem_config);
+
+        PrintTrips();
+        if (dtlb_misses) {
+            dtlb_misses->Disable();
+            PrintTlbMisses(dtlb_misses->Read(), cycles);
+        }
+        const gsync::CycleClock* cycle_clock =
+            std::get_if<gsync::CycleClock>(&any_clock);
+        if (cycle_clock) {
+            PrintCycleClock(*cycle_clock);
+        }
+        if (marker) {
+            std::cout << "trace: written=" << marker->Written()
+                      << " failed=" << marker->Failed() << std::endl;
+        }
+
+        const gsync::AdaptiveKuramotoSync* adaptive =
+            std::get_if<gsync::AdaptiveKuramotoSync>(&any_sync);
+        if (adaptive) {
+            PrintCouplingTrajectory(adaptive->Adaptive());
+        }
     } catch (const std::exception& e) {
         std::cerr << e.what() << std::endl;
         return 1;
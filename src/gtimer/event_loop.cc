@@ -0,0 +1,160 @@
+#include "event_loop.hpp"
+
+#include <cstdint>
+#include <iostream>
+#include <system_error>
+
+#include "sync/phase.hpp"
+#include "sync/policy.hpp"
+#include "util/perf/histogram.hpp"
+#include "util/tripwire/tripwire.hpp"
+#include "util/usdt/usdt.hpp"
+
+/* Edge timestamps further than this from our wakeup aren't on our clock,
+ * e.g., a pre-5.7 kernel stamped them with CLOCK_REALTIME. */
+static const int64_t kMaxIrqLatencyNs = 1000000000;
+
+static void PrintHistogram(const char* name,
+                           const gsync::LatencyHistogram& histogram) {
+    std::cout << name << ": samples=" << histogram.Count()
+              << " min_ns=" << histogram.Min()
+              << " mean_ns=" << histogram.Mean()
+              << " p50_ns=" << histogram.Percentile(0.5)
+              << " p99_ns=" << histogram.Percentile(0.99)
+              << " p999_ns=" << histogram.Percentile(0.999)
+              << " max_ns=" << histogram.Max() << std::endl;
+}
+
+static void PrintTelemetry(uint64_t edges, uint64_t io_errors,
+                           uint64_t unstamped,
+                           const gsync::LatencyHistogram& irq_latency,
+                           const gsync::LatencyHistogram& wake_to_publish) {
+    std::cout << "edges: captured=" << edges << " io_errors=" << io_errors
+              << " unstamped=" << unstamped << std::endl;
+    PrintHistogram("irq_latency", irq_latency);
+    PrintHistogram("wake_to_publish", wake_to_publish);
+}
+
+/* Wait for rising edge events on the GPIO. When an event comes, log the
+ * CLOCK_MONOTONIC time in shared memory. In echo mode, each event is also
+ * bounced straight back to the peer on the echo GPIO so that the peer can
+ * calibrate its capture latency.
+ *
+ * Every edge's kernel timestamp is compared against the time we woke up to
+ * handle it. That gap is the IRQ to user space latency: the GPIO IRQ
+ * thread and then us getting scheduled. It's kept in a histogram along with
+ * the time from our wakeup to the publish completing. */
+template <gsync::ClockPolicy Clock, gsync::EdgeLinePolicy Line,
+          gsync::LinePolicy Echo, gsync::PublishChannelPolicy Channel>
+static bool RunEdges(Clock& clock, Line& runtime_line, Echo& echo_line,
+                     Channel& runtime_channel,
+                     const gsync::mem::Config& mem_config,
+                     gsync::TraceMarker* marker) {
+    /* Auto sized memory regions are prefaulted after the first few edges.
+     * The tripwire, if compiled in, is armed right after. */
+    const uint64_t kMemWarmupEdges = 16;
+    const bool kMemAuto = (!mem_config.stack_size || !mem_config.heap_size);
+
+    uint64_t edges = 0;
+    uint64_t io_errors = 0;
+    uint64_t unstamped = 0;
+    gsync::LatencyHistogram irq_latency;
+    gsync::LatencyHistogram wake_to_publish;
+    while (!exit_gtimer) {
+        if (dump_telemetry) {
+            gsync::tripwire::Pause pause;
+            dump_telemetry = false;
+            PrintTelemetry(edges, io_errors, unstamped, irq_latency,
+                           wake_to_publish);
+        }
+
+        /* Block until the next event occurs on the line. SIGINT interrupts
+         * the wait, in which case there is no edge to record and the loop
+         * condition takes us out. SIGUSR1 interrupts it too, to report. */
+        gsync::Expected<timespec> edge = runtime_line.WaitForEdge();
+        if (!edge) {
+            if (edge.Error() == std::errc::interrupted) {
+                continue;
+            }
+            gsync::tripwire::Disarm();
+            std::cerr << "error: failed to wait for edge: "
+                      << edge.Error().message() << std::endl;
+            return false;
+        }
+        timespec woke = clock.Now();
+        int64_t irq_ns = gsync::TsToNano(edge.Value());
+        int64_t woke_ns = gsync::TsToNano(woke);
+        if ((woke_ns >= irq_ns) && ((woke_ns - irq_ns) <= kMaxIrqLatencyNs)) {
+            irq_latency.Add(woke_ns - irq_ns);
+        } else {
+            unstamped++;
+        }
+
+        if (!echo_line.SetValue(1)) {
+            io_errors++;
+        }
+        if (!echo_line.SetValue(0)) {
+            io_errors++;
+        }
+
+        /* Record the peer's last runtime in shmem. The timestamp is taken
+         * before the lock so that contending with gsync's read doesn't delay
+         * it. */
+        timespec captured = clock.Now();
+        GSYNC_PROBE3(edge_captured, gsync::TsToNano(captured), irq_ns, edges);
+        if (marker) {
+            (void)marker->Mark("edge",
+                               {{"seq", static_cast<int64_t>(edges)},
+                                {"t_ns", gsync::TsToNano(captured)},
+                                {"irq_ns", irq_ns}});
+        }
+        bool published = static_cast<bool>(runtime_channel.Publish(captured));
+        if (!published) {
+            io_errors++;
+        }
+        wake_to_publish.Add(gsync::TsToNano(clock.Now()) - woke_ns);
+        GSYNC_PROBE2(publish, gsync::TsToNano(captured),
+                     static_cast<int>(published));
+        if (marker) {
+            (void)marker->Mark("publish",
+                               {{"seq", static_cast<int64_t>(edges)},
+                                {"t_ns", gsync::TsToNano(captured)},
+                                {"ok", static_cast<int64_t>(published)}});
+        }
+
+        if (++edges == kMemWarmupEdges) {
+            if (kMemAuto) {
+                /* A failed prefault costs us page faults later on, not the
+                 * capture. Keep running. */
+                gsync::Expected<gsync::mem::Usage> prefaulted =
+                    gsync::mem::TryPrefaultMeasured(mem_config);
+                if (prefaulted) {
+                    std::cout << "auto prefault: stack="
+                              << prefaulted.Value().stack_bytes
+                              << " heap=" << prefaulted.Value().heap_bytes
+                              << std::endl;
+                } else {
+                    std::cerr << "warning: auto prefault failed: "
+                              << prefaulted.Error().message() << std::endl;
+                }
+            }
+            gsync::tripwire::Arm();
+        }
+        gsync::tripwire::CheckFaults();
+    }
+
+    gsync::tripwire::Disarm();
+    PrintTelemetry(edges, io_errors, unstamped, irq_latency, wake_to_publish);
+    return true;
+}
+
+bool RunEventLoop(AnyClock& any_clock, gsync::ConcreteBackend runtime_line,
+                  AnyEchoLine echo_line, gsync::ShMemChannel& channel,
+                  const gsync::mem::Config& mem_config,
+                  gsync::TraceMarker* marker) {
+    return std::visit(
+        [&](auto& clock, auto* line, auto* echo) {
+            return RunEdges(clock, *line, *echo, channel, mem_config, marker);
+        },
+        any_clock, runtime_line, echo_line);
+}
@@ -0,0 +1,55 @@
+#ifndef GTIMER_EVENT_LOOP_H_
+#define GTIMER_EVENT_LOOP_H_
+
+#include <atomic>
+#include <variant>
+
+#include "sync/clock.hpp"
+#include "util/gpio/backend.hpp"
+#include "util/gpio/resolve.hpp"
+#include "util/mem/mem.hpp"
+#include "util/shmem/channel.hpp"
+#include "util/trace/marker.hpp"
+
+/*
+ * gtimer's event loop. event_loop.cc is built with -fno-exceptions: everything
+ * that can fail is set up by main() beforehand and everything the loop calls
+ * reports failure through an error code.
+ */
+
+/** Set by SIGINT to stop the event loop. */
+extern std::atomic_bool exit_gtimer;
+
+/** Set by SIGUSR1 to request a telemetry report. */
+extern std::atomic_bool dump_telemetry;
+
+/* Clocks gtimer can timestamp edges with. */
+using AnyClock = std::variant<gsync::MonotonicClock, gsync::CycleClock>;
+
+/* Lines gtimer can echo edges back on. Each one, times each GPIO backend
+ * gtimer can listen on, gets its own event loop. Without echo mode, the echo
+ * line is a NullLine. */
+using AnyEchoLine = std::variant<gsync::NullLine*, gsync::GpiodBackend*,
+                                 gsync::VirtualGpioBackend*>;
+
+/**
+ * Run the event loop instantiated for the given clock and lines until SIGINT,
+ * then print its edge counts and latency histograms.
+ *
+ * @param[in] any_clock Clock edges are timestamped with.
+ * @param[in] runtime_line Line the peer's wakeup edges arrive on.
+ * @param[in] echo_line Line each edge is echoed back on.
+ * @param[in] channel Channel capture times are published on.
+ * @param[in] mem_config Memory config, for sizing auto prefaulted regions.
+ * @param[in] marker If not null, each edge and publish is marked in the
+ * ftrace buffer.
+ *
+ * @returns false if the loop stopped on an error rather than on SIGINT. The
+ *          error has been reported.
+ */
+bool RunEventLoop(AnyClock& any_clock, gsync::ConcreteBackend runtime_line,
+                  AnyEchoLine echo_line, gsync::ShMemChannel& channel,
+                  const gsync::mem::Config& mem_config,
+                  gsync::TraceMarker* marker);
+
+#endif
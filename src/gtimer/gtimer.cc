@@ -5,18 +5,39 @@
 
 #include <atomic>
 #include <iostream>
+#include <optional>
+#include <string>
+#include <variant>
 
+#include "event_loop.hpp"
+#include "sync/rate.hpp"
+#include "util/gpio/backend.hpp"
 #include "util/gpio/gpio.hpp"
+#include "util/gpio/resolve.hpp"
 #include "util/mem/mem.hpp"
+#include "util/sched/sched.hpp"
+#include "util/shmem/channel.hpp"
 #include "util/shmem/shmem.hpp"
+#include "util/trace/marker.hpp"
+#include "util/tripwire/tripwire.hpp"
 
 /* An atomic_bool used within a signal handler context must be lock free. */
 static_assert(std::atomic<bool>::is_always_lock_free);
 std::atomic_bool exit_gtimer = false;
 
+std::atomic_bool dump_telemetry = false;
+
 static void ExitHandler(int sig) {
     (void)sig; /* Cast to void to avoid unused variable warning. */
     exit_gtimer = true;
+
+    /* Whatever the loop does on its way out isn't on the real-time path. */
+    gsync::tripwire::Disarm();
+}
+
+static void TelemetryHandler(int sig) {
+    (void)sig; /* Cast to void to avoid unused variable warning. */
+    dump_telemetry = true;
 }
 
 static int InitAction(int sig, int flags, void (*handler)(int)) {
@@ -28,31 +49,41 @@ static int InitAction(int sig, int flags, void (*handler)(int)) {
     return sigaction(sig, &action, NULL);
 }
 
-/* Wait for rising edge events on the GPIO. When an event comes, log the
- * CLOCK_MONOTONIC time in shared memory. */
-static void RunEventLoop(gsync::Gpio& runtime_gpio,
-                         gsync::IpShMemData<struct timespec>* runtime_shmem) {
-    while (!exit_gtimer) {
-        try {
-            /* Block until the next event occurs on the line. */
-            runtime_gpio.WaitForEdge();
-        } catch (const std::system_error& e) {
-            /* We expect Gpio::WaitForEdge() to be interrupted when the user
-             * sends SIGINT to exit the program. libgpiod will throw an
-             * exception in this case. We can safely ignore that exception. */
-        }
-
-        /* Record the peer's last runtime in shmem. */
-        runtime_shmem->Lock();
-        clock_gettime(CLOCK_MONOTONIC, &runtime_shmem->data);
-        runtime_shmem->Unlock();
-    }
-}
-
 static void PrintUsage() {
     std::cout << "usage: gtimer [OPTION]... GPIO_DEVNAME GPIO_OFFSET SHMEM_KEY"
               << std::endl;
     std::cout << "GPIO Signal Time Recorder" << std::endl;
+    std::cout << "\t-e, --echo\techo each edge back to the peer on the "
+                 "given output GPIO offset"
+              << std::endl;
+    std::cout << "\t-f, --frequency\tspecify the peer's sync frequency in "
+                 "Hz, used to size the SCHED_DEADLINE period"
+              << std::endl;
+    std::cout << "\t-P, --fifo\trun under SCHED_FIFO at the given priority"
+              << std::endl;
+    std::cout << "\t-D, --dl-runtime\trun under SCHED_DEADLINE with the "
+                 "given runtime in ns"
+              << std::endl;
+    std::cout << "\t-A, --cpu\tpin to the given CPU, not with -D"
+              << std::endl;
+    std::cout << "\t-S, --cpuset\tmove into the given cgroup directory"
+              << std::endl;
+    std::cout << "\t-z, --stack-size\tspecify stack bytes to prefault, "
+                 "e.g. 512K, or auto to size off of a warm-up"
+              << std::endl;
+    std::cout << "\t-H, --heap-size\tspecify heap bytes to prefault, e.g. "
+                 "8M, or auto to size off of a warm-up"
+              << std::endl;
+    std::cout << "\t-l, --lock\tspecify memory lock policy: all (default), "
+                 "onfault or regions"
+              << std::endl;
+    std::cout << "\t-K, --clock\tspecify the edge timestamp clock: "
+                 "monotonic (default) or cycles, the cycle counter calibrated "
+                 "against CLOCK_MONOTONIC"
+              << std::endl;
+    std::cout << "\t-X, --trace-marker\tmark each edge and publish in the "
+                 "ftrace buffer through trace_marker"
+              << std::endl;
     std::cout << "\t-h, --help\tprint this help page" << std::endl;
     std::cout << "\tGPIO_DEVNAME\tspecify input gpio device name" << std::endl;
     std::cout << "\tGPIO_OFFSET\tspecify input gpio offset" << std::endl;
@@ -60,16 +91,122 @@ static void PrintUsage() {
 }
 
 int main(int argc, char** argv) {
+    const int kDefaultFreqHz = 100;
+
     struct option long_options[] = {
+        {"echo", required_argument, 0, 'e'},
+        {"frequency", required_argument, 0, 'f'},
+        {"fifo", required_argument, 0, 'P'},
+        {"dl-runtime", required_argument, 0, 'D'},
+        {"cpu", required_argument, 0, 'A'},
+        {"cpuset", required_argument, 0, 'S'},
+        {"stack-size", required_argument, 0, 'z'},
+        {"heap-size", required_argument, 0, 'H'},
+        {"lock", required_argument, 0, 'l'},
+        {"clock", required_argument, 0, 'K'},
+        {"trace-marker", no_argument, 0, 'X'},
         {"help", no_argument, 0, 'h'},
         {0, 0, 0, 0},
     };
     int opt = '\0';
     int long_index = 0;
-    while (-1 != (opt = getopt_long(argc, argv, "h",
+    int echo_offset = -1;
+    gsync::SyncRate rate = gsync::SyncRate::FromHz(kDefaultFreqHz);
+    gsync::sched::Config sched_config;
+    gsync::mem::Config mem_config;
+    std::string clock_source = "monotonic";
+    bool use_trace_marker = false;
+    while (-1 != (opt = getopt_long(argc, argv, "he:f:P:D:A:S:z:H:l:K:X",
                                     static_cast<struct option*>(long_options),
                                     &long_index))) {
         switch (opt) {
+            case 'e':
+                try {
+                    echo_offset = std::stoi(optarg);
+                } catch (const std::logic_error& e) {
+                    std::cerr << "error: echo offset must be a postive integer"
+                              << std::endl;
+                    return 1;
+                }
+                break;
+            case 'f':
+                try {
+                    rate = gsync::SyncRate::Parse(optarg);
+                } catch (const std::runtime_error& e) {
+                    std::cerr << "error: " << e.what() << std::endl;
+                    return 1;
+                }
+                break;
+            case 'P':
+                try {
+                    sched_config.policy = gsync::sched::Policy::kFifo;
+                    sched_config.priority = std::stoi(optarg);
+                } catch (const std::logic_error& e) {
+                    std::cerr << "error: fifo priority must be an integer in "
+                                 "the range [1, 99]"
+                              << std::endl;
+                    return 1;
+                }
+                break;
+            case 'D':
+                try {
+                    sched_config.policy = gsync::sched::Policy::kDeadline;
+                    sched_config.runtime_ns = std::stoull(optarg);
+                } catch (const std::logic_error& e) {
+                    std::cerr << "error: deadline runtime must be a positive "
+                                 "integer"
+                              << std::endl;
+                    return 1;
+                }
+                break;
+            case 'A':
+                try {
+                    sched_config.cpu = std::stoi(optarg);
+                } catch (const std::logic_error& e) {
+                    std::cerr << "error: cpu must be a non-negative integer"
+                              << std::endl;
+                    return 1;
+                }
+                break;
+            case 'S':
+                sched_config.cpuset = optarg;
+                break;
+            case 'z':
+            case 'H':
+                try {
+                    std::optional<std::size_t>& size =
+                        (opt == 'z') ? mem_config.stack_size
+                                     : mem_config.heap_size;
+                    if (std::string(optarg) == "auto") {
+                        size.reset();
+                    } else {
+                        size = gsync::mem::ParseSize(optarg);
+                    }
+                } catch (const std::runtime_error& e) {
+                    std::cerr << "error: " << e.what() << std::endl;
+                    return 1;
+                }
+                break;
+            case 'l':
+                try {
+                    mem_config.lock = gsync::mem::ParseLockPolicy(optarg);
+                } catch (const std::runtime_error& e) {
+                    std::cerr << "error: " << e.what() << std::endl;
+                    return 1;
+                }
+                break;
+            case 'K':
+                clock_source = optarg;
+                if (clock_source != "monotonic" && clock_source != "cycles") {
+                    std::cerr << "error: clock must be one of monotonic or "
+                                 "cycles"
+                              << std::endl;
+                    return 1;
+                }
+                break;
+            case 'X':
+                use_trace_marker = true;
+                break;
             case 'h':
                 PrintUsage();
                 return 0;
@@ -77,6 +214,13 @@ int main(int argc, char** argv) {
                 return 1;
         }
     }
+    if ((sched_config.cpu >= 0) &&
+        (sched_config.policy == gsync::sched::Policy::kDeadline)) {
+        std::cerr << "error: SCHED_DEADLINE tasks can't be pinned with -A, "
+                     "use -S with an exclusive cpuset instead"
+                  << std::endl;
+        return 1;
+    }
     if (!argv[optind]) {
         std::cerr << "error: missing GPIO_DEVNAME" << std::endl;
         return 1;
@@ -96,10 +240,29 @@ int main(int argc, char** argv) {
         return 1;
     }
 
+    /* Use the SIGUSR1 signal to request a telemetry report. */
+    if (-1 == InitAction(SIGUSR1, 0, TelemetryHandler)) {
+        perror("failed to register SIGUSR1 handler");
+        return 1;
+    }
+
     try {
         /* See https://programmador.com/posts/real-time-linux-app-development/
          */
-        gsync::mem::ConfigureMemForRt();
+        gsync::mem::ConfigureMemForRt(mem_config);
+
+        /* Edges arrive at most once per peer period, so the peer's period
+         * bounds both our deadline and our reservation period. */
+        sched_config.deadline_ns =
+            static_cast<uint64_t>(rate.NominalPeriod());
+        sched_config.period_ns = sched_config.deadline_ns;
+        gsync::sched::ConfigureSchedForRt(sched_config);
+        std::cout << "scheduling: " << gsync::sched::DescribeSched()
+                  << std::endl;
+        if (!gsync::sched::IsRealTime()) {
+            std::cerr << "warning: not running under a real-time policy"
+                      << std::endl;
+        }
 
         /* Allocate shared memory slot for storing our peers' last runtime. */
         gsync::IpShMem<struct timespec> shmem_ctrl(std::stoi(argv[optind + 2]));
@@ -110,7 +273,52 @@ int main(int argc, char** argv) {
         gsync::Gpio runtime_gpio(argv[optind], std::stoi(argv[optind + 1]));
         runtime_gpio.EdgeType(gsync::Gpio::Edge::kRising);
 
-        RunEventLoop(runtime_gpio, runtime_shmem);
+        /* Config the GPIO we echo edges back to the peer on. */
+        std::optional<gsync::Gpio> echo_gpio;
+        if (echo_offset >= 0) {
+            echo_gpio.emplace(argv[optind], echo_offset);
+            echo_gpio->Dir(gsync::Gpio::Direction::kOutput);
+            echo_gpio->Val(gsync::Gpio::Value::kLow);
+        }
+
+        std::cout << "memory: locked=" << gsync::mem::LockedBytes()
+                  << " resident=" << gsync::mem::ResidentBytes() << std::endl;
+
+        /* Resolve every policy to its concrete type here, once, and run the
+         * event loop instantiated for that combination. */
+        gsync::NullLine no_echo;
+        AnyEchoLine any_echo = &no_echo;
+        if (echo_gpio) {
+            std::visit([&any_echo](auto* backend) { any_echo = backend; },
+                       gsync::ResolveBackend(*echo_gpio));
+        }
+        AnyClock any_clock;
+        if (clock_source == "cycles") {
+            any_clock.emplace<gsync::CycleClock>();
+        }
+        std::optional<gsync::TraceMarker> marker;
+        if (use_trace_marker) {
+            marker.emplace("gtimer");
+            std::cout << "trace: marker=" << marker->Path() << std::endl;
+        }
+        gsync::ShMemChannel runtime_channel(runtime_shmem);
+        if (!RunEventLoop(any_clock, gsync::ResolveBackend(runtime_gpio),
+                          any_echo, runtime_channel, mem_config,
+                          (marker) ? &*marker : nullptr)) {
+            return 1;
+        }
+        if (marker) {
+            std::cout << "trace: written=" << marker->Written()
+                      << " failed=" << marker->Failed() << std::endl;
+        }
+
+        if (gsync::tripwire::kEnabled) {
+            const gsync::tripwire::Trips kTrips = gsync::tripwire::Count();
+            std::cout << "tripwire: allocations=" << kTrips.allocations
+                      << " frees=" << kTrips.frees
+                      << " minor_faults=" << kTrips.minor_faults
+                      << " major_faults=" << kTrips.major_faults << std::endl;
+        }
     } catch (const std::exception& e) {
         std::cerr << e.what() << std::endl;
         return 1;
@@ -0,0 +1,89 @@
+#include "sync/adaptive.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace gsync {
+
+AdaptiveCoupling::AdaptiveCoupling(const Config& config)
+    : config_(config),
+      k_(config.k_max),
+      mean_(0.0),
+      var_(0.0),
+      cycle_(0),
+      reacquisitions_(0),
+      last_logged_k_(config.k_max),
+      logged_(0),
+      trajectory_() {
+    if (config_.k_min <= 0.0) {
+        throw std::runtime_error("minimum coupling constant must be positive");
+    }
+    if (config_.k_max < config_.k_min) {
+        throw std::runtime_error(
+            "maximum coupling constant must not be less than the minimum");
+    }
+    if (config_.decay <= 0.0 || config_.decay >= 1.0) {
+        throw std::runtime_error("decay must be in the range (0, 1)");
+    }
+    Log(true);
+}
+
+void AdaptiveCoupling::Log(bool reacquire) {
+    trajectory_[logged_ % kTrajectorySize] = {
+        .cycle = cycle_,
+        .k = k_,
+        .error_mean = mean_,
+        .error_stddev = std::sqrt(var_),
+        .reacquire = reacquire,
+    };
+    logged_++;
+    last_logged_k_ = k_;
+}
+
+const AdaptiveCoupling::Sample& AdaptiveCoupling::TrajectoryAt(
+    std::size_t i) const {
+    std::size_t oldest = (logged_ < kTrajectorySize) ? 0 : logged_;
+    return trajectory_[(oldest + i) % kTrajectorySize];
+}
+
+double AdaptiveCoupling::Update(double phase_error) {
+    cycle_++;
+
+    /* A phase error that is way outside of the distribution we have been
+     * measuring means the peer jumped. Start the acquisition over. */
+    double deviation = std::fabs(phase_error - mean_);
+    if ((cycle_ > 1) && (std::fabs(phase_error) > kReacquireFloor) &&
+        (deviation > (kReacquireSigma * std::sqrt(var_)))) {
+        k_ = config_.k_max;
+        mean_ = phase_error;
+        var_ = phase_error * phase_error;
+        reacquisitions_++;
+        Log(true);
+        return k_;
+    }
+
+    /* Exponentially weighted mean and variance of the phase error. */
+    double delta = phase_error - mean_;
+    mean_ += kStatsAlpha * delta;
+    var_ = (1.0 - kStatsAlpha) * (var_ + (kStatsAlpha * delta * delta));
+
+    /* The share of the mean square error that comes from bias rather than
+     * jitter decides where between the bounds K should settle. */
+    double bias_sq = mean_ * mean_;
+    double mse = bias_sq + var_;
+    double bias_share = (mse > 0.0) ? (bias_sq / mse) : 0.0;
+    double target =
+        config_.k_min + ((config_.k_max - config_.k_min) * bias_share);
+
+    k_ = target + ((k_ - target) * config_.decay);
+    k_ = std::clamp(k_, config_.k_min, config_.k_max);
+
+    if (std::fabs(k_ - last_logged_k_) > (kLogThreshold * last_logged_k_)) {
+        Log(false);
+    }
+
+    return k_;
+}
+
+}  // namespace gsync
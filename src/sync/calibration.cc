@@ -0,0 +1,86 @@
+#include "sync/calibration.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <stdexcept>
+
+namespace gsync {
+
+LatencyCalibration::LatencyCalibration(std::size_t capacity,
+                                       std::pmr::memory_resource* resource)
+    : capacity_(capacity), rtts_(resource) {
+    if (capacity_ == 0) {
+        throw std::runtime_error("calibration capacity must be positive");
+    }
+    rtts_.reserve(capacity_);
+}
+
+bool LatencyCalibration::AddRoundTrip(int64_t rtt_ns) {
+    if ((rtt_ns <= 0) || (rtts_.size() >= capacity_)) {
+        return false;
+    }
+    rtts_.push_back(rtt_ns);
+    return true;
+}
+
+LatencyCalibration::Stats LatencyCalibration::RoundTripStats() const {
+    if (rtts_.empty()) {
+        throw std::runtime_error("no round trips recorded");
+    }
+
+    std::pmr::vector<int64_t> sorted(rtts_, rtts_.get_allocator());
+    std::sort(sorted.begin(), sorted.end());
+
+    double sum = 0.0;
+    for (int64_t rtt : sorted) {
+        sum += static_cast<double>(rtt);
+    }
+    double mean = sum / static_cast<double>(sorted.size());
+
+    double sq_sum = 0.0;
+    for (int64_t rtt : sorted) {
+        double delta = static_cast<double>(rtt) - mean;
+        sq_sum += delta * delta;
+    }
+
+    Stats stats = {
+        .count = sorted.size(),
+        .min = sorted.front(),
+        .max = sorted.back(),
+        .median = sorted[sorted.size() / 2],
+        .mean = mean,
+        .stddev = std::sqrt(sq_sum / static_cast<double>(sorted.size())),
+    };
+    return stats;
+}
+
+void SaveLatency(const std::string& path, int64_t latency_ns) {
+    std::ofstream file(path);
+    if (!file) {
+        throw std::runtime_error("unable to open calibration file '" + path +
+                                 "' for writing");
+    }
+    file << latency_ns << std::endl;
+    if (!file) {
+        throw std::runtime_error("failed to write calibration file '" + path +
+                                 "'");
+    }
+}
+
+int64_t LoadLatency(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) {
+        throw std::runtime_error("unable to open calibration file '" + path +
+                                 "'");
+    }
+
+    int64_t latency_ns = 0;
+    if (!(file >> latency_ns) || (latency_ns < 0)) {
+        throw std::runtime_error("invalid latency in calibration file '" +
+                                 path + "'");
+    }
+    return latency_ns;
+}
+
+}  // namespace gsync
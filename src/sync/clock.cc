@@ -0,0 +1,157 @@
+#include "sync/clock.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+namespace gsync {
+
+/* Time spent measuring the counter's rate on construction. */
+static const int64_t kInitialCalibrationNs = 10000000;
+
+/* First recalibration interval. */
+static const int64_t kFirstIntervalNs = 100000000;
+
+/* Longest recalibration interval, see CycleClock::kShift. */
+static const int64_t kMaxRecalibrationNs = 2 * kNanoPerSec;
+
+/* Readings taken per sample. The one with the narrowest counter bracket
+ * around its clock_gettime() wins. */
+static const int kSampleTries = 3;
+
+static const double kFixedPointOne = 4294967296.0; /* 1 << kShift */
+
+#if defined(__x86_64__) || defined(__i386__)
+/* The TSC can only stand in for CLOCK_MONOTONIC if it ticks at a constant
+ * rate, whatever the core's frequency, and keeps ticking in deep sleep. */
+static bool HasInvariantTsc() {
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::string line;
+    while (std::getline(cpuinfo, line)) {
+        if (line.rfind("flags", 0) == 0) {
+            line += ' ';
+            return (line.find(" constant_tsc ") != std::string::npos) &&
+                   (line.find(" nonstop_tsc ") != std::string::npos);
+        }
+    }
+    return false;
+}
+#endif
+
+CycleClock::CycleClock(int64_t recalibration_ns,
+                       const std::atomic_bool* stop)
+    : base_ticks_(0),
+      base_ns_(0),
+      mult_(0),
+      recalibration_ticks_(0),
+      recalibration_ns_(recalibration_ns),
+      interval_ns_(std::min(kFirstIntervalNs, recalibration_ns)),
+      ns_per_tick_(0.0),
+      last_sample_{},
+      recalibrations_(0),
+      last_offset_ns_(0),
+      stop_(stop) {
+    if (!kHasCycleCounter) {
+        throw std::runtime_error(
+            "no user space cycle counter on this platform");
+    }
+#if defined(__x86_64__) || defined(__i386__)
+    if (!HasInvariantTsc()) {
+        throw std::runtime_error("TSC is not invariant");
+    }
+#endif
+    if ((recalibration_ns <= 0) || (recalibration_ns > kMaxRecalibrationNs)) {
+        throw std::runtime_error(
+            "recalibration interval must be in the range (0, 2] seconds");
+    }
+
+    const timespec kWait = NanoToTs(kInitialCalibrationNs);
+    Sample first = TakeSample();
+    clock_nanosleep(CLOCK_MONOTONIC, 0, &kWait, NULL);
+    last_sample_ = TakeSample();
+    if (last_sample_.ticks == first.ticks) {
+        throw std::runtime_error("cycle counter is not running");
+    }
+    ns_per_tick_ = static_cast<double>(last_sample_.mono_ns - first.mono_ns) /
+                   static_cast<double>(last_sample_.ticks - first.ticks);
+
+    base_ticks_ = last_sample_.ticks;
+    base_ns_ = last_sample_.mono_ns;
+    mult_ = static_cast<uint64_t>(ns_per_tick_ * kFixedPointOne);
+    recalibration_ticks_ = static_cast<uint64_t>(
+        static_cast<double>(interval_ns_) / ns_per_tick_);
+}
+
+double CycleClock::FrequencyHz() const {
+    return static_cast<double>(kNanoPerSec) / ns_per_tick_;
+}
+
+CycleClock::Sample CycleClock::TakeSample() {
+    Sample best = {};
+    uint64_t best_width = UINT64_MAX;
+    for (int i = 0; i < kSampleTries; ++i) {
+        timespec mono = {};
+        uint64_t before = ReadCycleCounter();
+        clock_gettime(CLOCK_MONOTONIC, &mono);
+        uint64_t after = ReadCycleCounter();
+        if ((after - before) < best_width) {
+            best_width = after - before;
+            best.ticks = before + (best_width / 2);
+            best.mono_ns = TsToNano(mono);
+        }
+    }
+    return best;
+}
+
+void CycleClock::Recalibrate() {
+    Sample now = TakeSample();
+
+    /* Where the current conversion puts us versus where CLOCK_MONOTONIC
+     * actually is. The conversion is only ever continued from this point, so
+     * what we hand out never jumps backwards. The slewed rate only holds for
+     * one interval. If we weren't called for longer than that, the rest is
+     * converted at the unslewed rate. */
+    uint64_t elapsed = now.ticks - base_ticks_;
+    uint64_t slewed = std::min(elapsed, recalibration_ticks_);
+    int64_t estimate_ns =
+        base_ns_ +
+        static_cast<int64_t>(static_cast<double>(slewed) *
+                                 (static_cast<double>(mult_) /
+                                  kFixedPointOne) +
+                             static_cast<double>(elapsed - slewed) *
+                                 ns_per_tick_);
+    int64_t offset_ns = now.mono_ns - estimate_ns;
+
+    /* Track the counter's rate over the last interval. */
+    if ((now.ticks > last_sample_.ticks) &&
+        (now.mono_ns > last_sample_.mono_ns)) {
+        ns_per_tick_ = static_cast<double>(now.mono_ns - last_sample_.mono_ns) /
+                       static_cast<double>(now.ticks - last_sample_.ticks);
+    }
+    last_sample_ = now;
+    last_offset_ns_ = offset_ns;
+    recalibrations_++;
+
+    /* Slew small offsets out over the next interval by running a little fast
+     * or slow. An offset too large to slew, e.g., after a stall, is stepped
+     * out if we are behind. If we are ahead, it is slewed out at the
+     * largest rate over several intervals. */
+    interval_ns_ = std::min(interval_ns_ * 2, recalibration_ns_);
+    const int64_t kMaxSlewNs = interval_ns_ / 10;
+    base_ticks_ = now.ticks;
+    if (offset_ns > kMaxSlewNs) {
+        base_ns_ = now.mono_ns;
+        offset_ns = 0;
+    } else {
+        base_ns_ = estimate_ns;
+        offset_ns = std::max(offset_ns, -kMaxSlewNs);
+    }
+    double slew = static_cast<double>(interval_ns_ + offset_ns) /
+                  static_cast<double>(interval_ns_);
+    mult_ = static_cast<uint64_t>(ns_per_tick_ * slew * kFixedPointOne);
+    recalibration_ticks_ = static_cast<uint64_t>(
+        static_cast<double>(interval_ns_) / ns_per_tick_);
+}
+
+}  // namespace gsync
@@ -0,0 +1,96 @@
+#include "sync/estimator.hpp"
+
+#include <cmath>
+#include <stdexcept>
+
+#include "sync/phase.hpp"
+
+namespace gsync {
+
+PeerEstimator::PeerEstimator(const SyncRate& rate, const Config& config)
+    : nominal_period_(rate.PeriodNs()),
+      r_(config.measurement_noise_ns * config.measurement_noise_ns),
+      q_phase_(config.phase_noise_ns * config.phase_noise_ns),
+      q_period_(config.period_noise_ns * config.period_noise_ns),
+      initialized_(false),
+      origin_(0),
+      phase_(0.0),
+      period_(0.0),
+      p00_(0.0),
+      p01_(0.0),
+      p11_(0.0),
+      reinits_(0) {
+    if (config.measurement_noise_ns <= 0.0) {
+        throw std::runtime_error("measurement noise must be greater than 0");
+    }
+    if (config.phase_noise_ns < 0.0 || config.period_noise_ns < 0.0) {
+        throw std::runtime_error("process noise must not be negative");
+    }
+
+    period_ = nominal_period_;
+}
+
+void PeerEstimator::Init(int64_t sample_ns) {
+    /* Start from the raw sample and the nominal period. The period variance
+     * allows for a 100 ppm oscillator error. */
+    const double kInitialPeriodError = 100e-6 * nominal_period_;
+
+    origin_ = sample_ns;
+    phase_ = 0.0;
+    period_ = nominal_period_;
+    p00_ = r_;
+    p01_ = 0.0;
+    p11_ = kInitialPeriodError * kInitialPeriodError;
+    initialized_ = true;
+    reinits_++;
+}
+
+timespec PeerEstimator::Update(const timespec& peer_wakeup) {
+    int64_t z = TsToNano(peer_wakeup);
+    if (!initialized_) {
+        Init(z);
+        return peer_wakeup;
+    }
+
+    /* Number of peer cycles elapsed since the last estimate. */
+    double offset = static_cast<double>(z - origin_);
+    int64_t n = std::llround((offset - phase_) / period_);
+    if (n < 1) {
+        n = 1;
+    }
+    if (n > kMaxGapCycles) {
+        Init(z);
+        return peer_wakeup;
+    }
+
+    /* Predict: x = F * x, P = F * P * F' + n * Q, with F = [1 n; 0 1]. */
+    double dn = static_cast<double>(n);
+    double phase_pred = phase_ + (dn * period_);
+    double p00 = p00_ + (2.0 * dn * p01_) + (dn * dn * p11_) + (dn * q_phase_);
+    double p01 = p01_ + (dn * p11_);
+    double p11 = p11_ + (dn * q_period_);
+
+    double innovation = offset - phase_pred;
+    if (std::fabs(innovation) > (kReinitFraction * nominal_period_)) {
+        Init(z);
+        return peer_wakeup;
+    }
+
+    /* Correct with H = [1 0]. */
+    double s = p00 + r_;
+    double k0 = p00 / s;
+    double k1 = p01 / s;
+    phase_ = phase_pred + (k0 * innovation);
+    period_ += k1 * innovation;
+    p00_ = (1.0 - k0) * p00;
+    p01_ = (1.0 - k0) * p01;
+    p11_ = p11 - (k1 * p01);
+
+    /* Rebase the state on the new measurement. */
+    origin_ = z;
+    phase_ -= offset;
+
+    return NanoToTs(origin_ + std::llround(phase_));
+}
+
+}  // namespace gsync
@@ -0,0 +1,85 @@
+#include "sync/filter.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+
+namespace gsync {
+
+PhaseErrorWindow::PhaseErrorWindow(std::size_t window)
+    : window_(window), ring_(), head_(0), count_(0) {
+    if (window_ < 1 || window_ > kMaxWindow) {
+        throw std::runtime_error("filter window must be in the range [1, " +
+                                 std::to_string(kMaxWindow) + "]");
+    }
+}
+
+void PhaseErrorWindow::Push(int64_t phase_err) {
+    ring_[head_] = phase_err;
+    head_ = (head_ + 1) % window_;
+    if (count_ < window_) {
+        count_++;
+    }
+}
+
+int64_t PhaseErrorWindow::Median() const {
+    /* The ring is tiny, sorting a copy of it on the stack is cheap. */
+    std::array<int64_t, kMaxWindow> scratch = ring_;
+    auto mid = scratch.begin() + (count_ / 2);
+    std::nth_element(scratch.begin(), mid, scratch.begin() + count_);
+    return *mid;
+}
+
+int64_t PhaseErrorWindow::MedianAbsDeviation(int64_t median) const {
+    std::array<int64_t, kMaxWindow> deviations = {};
+    for (std::size_t i = 0; i < count_; ++i) {
+        deviations[i] = std::abs(ring_[i] - median);
+    }
+    auto mid = deviations.begin() + (count_ / 2);
+    std::nth_element(deviations.begin(), mid, deviations.begin() + count_);
+    return *mid;
+}
+
+MedianFilter::MedianFilter(std::size_t window)
+    : window_(window), accepted_(0) {}
+
+std::optional<int64_t> MedianFilter::Filter(int64_t phase_err) {
+    window_.Push(phase_err);
+    accepted_++;
+    return window_.Median();
+}
+
+MadFilter::MadFilter(std::size_t window, double mad_threshold)
+    : window_(window),
+      mad_threshold_(mad_threshold),
+      accepted_(0),
+      rejected_(0) {
+    if (mad_threshold_ <= 0.0) {
+        throw std::runtime_error("MAD threshold must be greater than 0");
+    }
+}
+
+std::optional<int64_t> MadFilter::Filter(int64_t phase_err) {
+    /* Gate the new sample against the window as it stood before the sample
+     * arrived. */
+    bool is_outlier = false;
+    if (window_.Count() >= kMinMadSamples) {
+        int64_t median = window_.Median();
+        int64_t mad =
+            std::max(window_.MedianAbsDeviation(median), kMinMadNano);
+
+        double gate = mad_threshold_ * kMadToSigma * static_cast<double>(mad);
+        is_outlier = (static_cast<double>(std::abs(phase_err - median)) > gate);
+    }
+    window_.Push(phase_err);
+
+    if (is_outlier) {
+        rejected_++;
+        return std::nullopt;
+    }
+    accepted_++;
+    return phase_err;
+}
+
+}  // namespace gsync
@@ -0,0 +1,17 @@
+#include "sync/loop.hpp"
+
+namespace gsync {
+
+bool IsTrustedSample(const timespec& peer_wakeup,
+                     const timespec& prev_peer_wakeup, int64_t period_ns) {
+    const int64_t kToleranceNano = period_ns / 10;
+
+    int64_t spacing = TsToNano(peer_wakeup) - TsToNano(prev_peer_wakeup);
+    if (spacing <= 0) {
+        return false;
+    }
+    int64_t jitter = PhaseErrorNano(prev_peer_wakeup, peer_wakeup, period_ns);
+    return (std::abs(jitter) < kToleranceNano);
+}
+
+}  // namespace gsync
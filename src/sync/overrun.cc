@@ -0,0 +1,62 @@
+#include "sync/overrun.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "sync/phase.hpp"
+
+namespace gsync {
+
+timespec SkipOverrun::Apply(timespec& wakeup, const timespec& now,
+                            int64_t period_ns) {
+    int64_t wakeup_ns = TsToNano(wakeup);
+    int64_t now_ns = TsToNano(now);
+    if (wakeup_ns <= now_ns) {
+        overruns_++;
+        int64_t missed = ((now_ns - wakeup_ns) / period_ns) + 1;
+        skipped_periods_ += static_cast<uint64_t>(missed);
+        wakeup = NanoToTs(wakeup_ns + (missed * period_ns));
+    }
+    return wakeup;
+}
+
+timespec FireOnceOverrun::Apply(timespec& wakeup, const timespec& now,
+                                int64_t period_ns) {
+    (void)period_ns;
+    if (TsToNano(wakeup) <= TsToNano(now)) {
+        overruns_++;
+        wakeup = now;
+    }
+    return wakeup;
+}
+
+CompressOverrun::CompressOverrun(double max_compression)
+    : max_compression_(max_compression), last_target_ns_(0), overruns_(0) {
+    if (max_compression_ <= 0.0 || max_compression_ >= 1.0) {
+        throw std::runtime_error("max compression must be in the range (0, 1)");
+    }
+}
+
+timespec CompressOverrun::Apply(timespec& wakeup, const timespec& now,
+                                int64_t period_ns) {
+    int64_t target_ns = TsToNano(wakeup);
+    int64_t now_ns = TsToNano(now);
+    if (target_ns <= now_ns) {
+        overruns_++;
+    }
+
+    /* Leave the schedule alone and pace the wakeups instead. Each period is
+     * at least (1 - max_compression) long so the lag shrinks by up to
+     * max_compression periods per cycle. */
+    int64_t min_gap_ns = static_cast<int64_t>(
+        (1.0 - max_compression_) * static_cast<double>(period_ns));
+    if (last_target_ns_) {
+        target_ns = std::max(target_ns, last_target_ns_ + min_gap_ns);
+    }
+    target_ns = std::max(target_ns, now_ns);
+    last_target_ns_ = target_ns;
+
+    return NanoToTs(target_ns);
+}
+
+}  // namespace gsync
@@ -0,0 +1,36 @@
+#include "sync/phase.hpp"
+
+namespace gsync {
+
+int64_t TsToNano(const timespec& ts) {
+    return (static_cast<int64_t>(ts.tv_sec) * kNanoPerSec) +
+           static_cast<int64_t>(ts.tv_nsec);
+}
+
+timespec NanoToTs(int64_t ns) {
+    int64_t sec = ns / kNanoPerSec;
+    int64_t nsec = ns % kNanoPerSec;
+    if (nsec < 0) {
+        sec--;
+        nsec += kNanoPerSec;
+    }
+
+    timespec ts = {
+        .tv_sec = static_cast<time_t>(sec),
+        .tv_nsec = static_cast<long>(nsec),
+    };
+    return ts;
+}
+
+int64_t PhaseErrorNano(const timespec& actual, const timespec& peer,
+                       int64_t period_ns) {
+    int64_t err = (TsToNano(peer) - TsToNano(actual)) % period_ns;
+    if (err < -(period_ns / 2)) {
+        err += period_ns;
+    } else if (err >= (period_ns - (period_ns / 2))) {
+        err -= period_ns;
+    }
+    return err;
+}
+
+}  // namespace gsync
@@ -0,0 +1,44 @@
+#include "sync/pll.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "sync/phase.hpp"
+
+namespace gsync {
+
+PllSync::PllSync(const SyncRate& rate, double kp, double ki)
+    : SyncController(rate),
+      period_ns_(rate.NominalPeriod()),
+      kp_(kp),
+      ki_(ki),
+      integrator_(0.0),
+      integrator_limit_(0.0) {
+    if (kp_ <= 0.0 || kp_ >= 1.0) {
+        throw std::runtime_error("kp must be in the range (0, 1)");
+    }
+    if (ki_ < 0.0 || ki_ >= kp_) {
+        throw std::runtime_error("ki must be in the range [0, kp)");
+    }
+
+    integrator_limit_ = kMaxCorrectionFraction * period_ns_;
+}
+
+timespec PllSync::ComputeNewWakeup(const timespec& actual_wakeup,
+                                   const timespec& peer_wakeup) {
+    double err = static_cast<double>(
+        PhaseErrorNano(actual_wakeup, peer_wakeup, period_ns_));
+
+    /* The integrator tracks the frequency offset between the two oscillators.
+     * Clamp it to avoid windup while the loop is still acquiring. */
+    integrator_ = std::clamp(integrator_ + (ki_ * err), -integrator_limit_,
+                             integrator_limit_);
+
+    double correction = (kp_ * err) + integrator_;
+
+    return NanoToTs(TsToNano(actual_wakeup) + rate_.NextPeriod() +
+                    std::llround(correction));
+}
+
+}  // namespace gsync
@@ -0,0 +1,32 @@
+#include "sync/probe.hpp"
+
+#include <time.h>
+
+namespace gsync {
+
+SpanProbe::SpanProbe()
+    : nanos_per_tick_(NanosPerTick()), start_(), spans_() {}
+
+double SpanProbe::NanosPerTick() {
+    if constexpr (!kHasCycleCounter) {
+        return 1.0;
+    }
+    static const double kNanosPerTick = []() {
+        const timespec kInterval = {.tv_sec = 0, .tv_nsec = 10000000};
+        timespec start = {};
+        timespec end = {};
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        uint64_t start_ticks = ReadCycleCounter();
+        clock_nanosleep(CLOCK_MONOTONIC, 0, &kInterval, NULL);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        uint64_t end_ticks = ReadCycleCounter();
+        if (end_ticks <= start_ticks) {
+            return 1.0;
+        }
+        return static_cast<double>(TsToNano(end) - TsToNano(start)) /
+               static_cast<double>(end_ticks - start_ticks);
+    }();
+    return kNanosPerTick;
+}
+
+}  // namespace gsync
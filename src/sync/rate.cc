@@ -0,0 +1,99 @@
+#include "sync/rate.hpp"
+
+#include <cmath>
+#include <cstddef>
+#include <numeric>
+#include <stdexcept>
+
+#include "sync/phase.hpp"
+
+namespace gsync {
+
+SyncRate::SyncRate(int64_t period_num, int64_t period_den)
+    : whole_(0), remainder_(0), divisor_(1), accum_(0) {
+    if (period_num <= 0 || period_den <= 0) {
+        throw std::runtime_error("sync period must be greater than 0");
+    }
+
+    int64_t gcd = std::gcd(period_num, period_den);
+    period_num /= gcd;
+    period_den /= gcd;
+
+    whole_ = period_num / period_den;
+    remainder_ = period_num % period_den;
+    divisor_ = period_den;
+    if (whole_ <= 0) {
+        throw std::runtime_error("sync period must be at least 1ns");
+    }
+}
+
+SyncRate SyncRate::FromHz(int64_t num, int64_t den) {
+    /* Bound the denominator so that kNanoPerSec * den can't overflow. */
+    const int64_t kMaxDen = INT64_MAX / kNanoPerSec;
+
+    if (num <= 0 || den <= 0) {
+        throw std::runtime_error("frequency must be greater than 0");
+    }
+    if (den > kMaxDen) {
+        throw std::runtime_error("frequency denominator is too large");
+    }
+    return SyncRate(kNanoPerSec * den, num);
+}
+
+SyncRate SyncRate::FromPeriodNs(int64_t period_ns) {
+    return SyncRate(period_ns, 1);
+}
+
+SyncRate SyncRate::Parse(const std::string& str) {
+    const int64_t kMaxDen = INT64_MAX / kNanoPerSec;
+
+    auto ParseInt = [&str](const std::string& digits) {
+        std::size_t len = 0;
+        int64_t val = 0;
+        try {
+            val = std::stoll(digits, &len);
+        } catch (const std::logic_error& e) {
+            len = 0;
+        }
+        if (digits.empty() || (len != digits.size()) || (val < 0)) {
+            throw std::runtime_error("invalid frequency '" + str + "'");
+        }
+        return val;
+    };
+
+    std::size_t slash = str.find('/');
+    if (slash != std::string::npos) {
+        return FromHz(ParseInt(str.substr(0, slash)),
+                      ParseInt(str.substr(slash + 1)));
+    }
+
+    /* A decimal is turned into the exact fraction digits / 10^places. */
+    std::size_t dot = str.find('.');
+    if (dot != std::string::npos) {
+        std::string fraction = str.substr(dot + 1);
+        int64_t den = 1;
+        for (std::size_t i = 0; i < fraction.size(); ++i) {
+            if (den > (kMaxDen / 10)) {
+                throw std::runtime_error("too many decimal places in '" + str +
+                                         "'");
+            }
+            den *= 10;
+        }
+        return FromHz(ParseInt(str.substr(0, dot) + fraction), den);
+    }
+
+    return FromHz(ParseInt(str));
+}
+
+double SyncRate::PeriodNs() const {
+    return static_cast<double>(whole_) +
+           (static_cast<double>(remainder_) / static_cast<double>(divisor_));
+}
+
+int64_t SyncRate::NominalPeriod() const { return std::llround(PeriodNs()); }
+
+double SyncRate::Hz() const {
+    return static_cast<double>(kNanoPerSec) / PeriodNs();
+}
+
+}  // namespace gsync
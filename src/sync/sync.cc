@@ -4,66 +4,69 @@
 #include <cstdint>
 #include <stdexcept>
 
+#include "sync/phase.hpp"
+
 namespace gsync {
 
-double KuramotoSync::ToNano(const timespec& ts) const {
-    double sec_to_nano = static_cast<double>(ts.tv_sec) * kSecToNano;
-    return (sec_to_nano + static_cast<double>(ts.tv_nsec));
+timespec SyncController::NominalWakeup(const timespec& from) {
+    return NanoToTs(TsToNano(from) + rate_.NextPeriod());
 }
 
-double KuramotoSync::NanoToRad(double ns) const {
-    static const double kConvFactor = (2 * kPi * frequency_) / kSecToNano;
-    return (kConvFactor * ns);
-}
+KuramotoModel::KuramotoModel(const SyncRate& rate)
+    : SyncController(rate),
+      /* The factors are per instance so that sync objects running at
+       * different rates can coexist in one process. */
+      rad_per_nano_((2 * kPi) / rate_.PeriodNs()),
+      nano_per_rad_(rate_.PeriodNs() / (2 * kPi)) {}
 
-double KuramotoSync::RadToNano(double rad) const {
-    static const double kConvFactor = (kSecToNano / (2 * kPi * frequency_));
-    return (kConvFactor * rad);
+double KuramotoModel::PhaseDifference(const timespec& actual_wakeup,
+                                      const timespec& peer_wakeup) const {
+    /* The phase difference is taken in integer nanoseconds first so that the
+     * radian conversion never has to represent an absolute time. */
+    int64_t dt_i = TsToNano(actual_wakeup);
+    int64_t dt_j = TsToNano(peer_wakeup);
+    return (rad_per_nano_ * static_cast<double>(dt_j - dt_i));
 }
 
-void KuramotoSync::NormalizeTime(timespec& ts) const {
-    static const int kNanoSecPerSec = 1e9;
-    while (ts.tv_nsec >= kNanoSecPerSec) {
-        ts.tv_sec++;
-        ts.tv_nsec -= kNanoSecPerSec;
-    }
+timespec KuramotoModel::Correct(const timespec& actual_wakeup,
+                                double dtheta_ji, double coupling_constant) {
+    /* Implementation of the common form of the Kuramoto Model as seen here
+     * https://en.wikipedia.org/wiki/Kuramoto_model. The natural frequency,
+     * omega_i, is one period which is drawn from the rate so that the
+     * fractional nanoseconds of non-integer periods are not lost. */
+    double coupling =
+        (coupling_constant / static_cast<double>(kNumParticipants)) *
+        std::sin(dtheta_ji);
+
+    /* The new wakeup time is an offset from the actual wakeup time. */
+    return NanoToTs(TsToNano(actual_wakeup) + rate_.NextPeriod() +
+                    static_cast<int64_t>(nano_per_rad_ * coupling));
 }
 
-KuramotoSync::KuramotoSync(int frequency, double coupling_constant)
-    : frequency_(frequency), coupling_constant_(coupling_constant) {
-    if (frequency_ <= 0) {
-        throw std::runtime_error("frequency must be greater than 0");
-    }
+KuramotoSync::KuramotoSync(const SyncRate& rate, double coupling_constant)
+    : KuramotoModel(rate), coupling_constant_(coupling_constant) {
     if (coupling_constant_ <= 0.0) {
         throw std::runtime_error("coupling constant must be greater than 0");
     }
 }
 
 timespec KuramotoSync::ComputeNewWakeup(const timespec& actual_wakeup,
-                                        const timespec& peer_wakeup) const {
-    /* Compute the variables of the Kuramoto Model for the current run. */
-    double omega_i = NanoToRad((1.0 / frequency_) * kSecToNano);
-    double dt_i = ToNano(actual_wakeup);
-    double dtheta_i = NanoToRad(dt_i);
-    double dt_j = ToNano(peer_wakeup);
-    double dtheta_j = NanoToRad(dt_j);
-
-    /* Implementation of the common form of the Kuramoto Model as seen here
-     * https://en.wikipedia.org/wiki/Kuramoto_model */
-    double dtheta_dt =
-        omega_i +
-        ((coupling_constant_ / static_cast<double>(kNumParticipants)) *
-         std::sin(dtheta_j - dtheta_i));
+                                        const timespec& peer_wakeup) {
+    return Correct(actual_wakeup, PhaseDifference(actual_wakeup, peer_wakeup),
+                   coupling_constant_);
+}
 
-    /* The new wakeup time is an offset from the actual wakeup time. */
-    timespec new_wakeup = {
-        .tv_sec = actual_wakeup.tv_sec,
-        .tv_nsec =
-            actual_wakeup.tv_nsec + static_cast<long>(RadToNano(dtheta_dt)),
-    };
-    NormalizeTime(new_wakeup);
+AdaptiveKuramotoSync::AdaptiveKuramotoSync(
+    const SyncRate& rate, const AdaptiveCoupling::Config& adaptive)
+    : KuramotoModel(rate), adaptive_(adaptive) {}
 
-    return new_wakeup;
-}  // namespace gsync
+timespec AdaptiveKuramotoSync::ComputeNewWakeup(const timespec& actual_wakeup,
+                                                const timespec& peer_wakeup) {
+    /* Let the adaptive coupling constant see the wrapped phase error. */
+    double dtheta_ji = PhaseDifference(actual_wakeup, peer_wakeup);
+    double coupling_constant =
+        adaptive_.Update(std::remainder(dtheta_ji, 2 * kPi));
+    return Correct(actual_wakeup, dtheta_ji, coupling_constant);
+}
 
 }  // namespace gsync
@@ -1,72 +1,76 @@
 #include "util/gpio/gpio.hpp"
 
-#include <chrono>
+#include <stdexcept>
 #include <string>
+#include <system_error>
+
+#include "util/gpio/backend.hpp"
+#include "util/gpio/gpiod_backend.hpp"
+#include "util/gpio/resolve.hpp"
+#include "util/gpio/vgpio.hpp"
 
 namespace gsync {
 
 Gpio::Gpio(const std::string& dev, int offset, const std::string& name)
-    : chip_(dev), name_(name), dir_(Direction::kOutput), edge_(Edge::kNone) {
-    line_ = chip_.get_line(offset);
+    : name_(name), dir_(Direction::kOutput), edge_(Edge::kNone) {
+    if (VirtualGpioBackend::IsVirtual(dev)) {
+        const std::size_t kPrefixLen =
+            std::string(VirtualGpioBackend::kDevPrefix).size();
+        backend_ = std::make_shared<VirtualGpioBackend>(dev.substr(kPrefixLen),
+                                                        offset);
+    } else {
+        backend_ = std::make_shared<GpiodBackend>(dev, offset);
+    }
 }
 
+std::string Gpio::ChipLabel() const { return backend_->ChipLabel(); }
+
+std::string Gpio::ChipName() const { return backend_->ChipName(); }
+
+std::string Gpio::LineName() const { return backend_->LineName(); }
+
+unsigned int Gpio::LineOffset() const { return backend_->LineOffset(); }
+
 void Gpio::Dir(Direction dir) {
-    switch (dir) {
-        case Direction::kInput:
-            line_.request({name_, gpiod::line_request::DIRECTION_INPUT, 0});
-            dir_ = Direction::kInput;
-            break;
-        case Direction::kOutput:
-            line_.request({name_, gpiod::line_request::DIRECTION_OUTPUT, 0});
-            dir_ = Direction::kOutput;
-            break;
-    }
+    backend_->Request(name_, dir);
+    dir_ = dir;
 }
 
 void Gpio::Val(Value value) const {
-    switch (value) {
-        case kHigh:
-            line_.set_value(1);
-            break;
-        case kLow:
-            line_.set_value(0);
-            break;
+    Expected<void> result = TryVal(value);
+    if (!result) {
+        throw std::system_error(result.Error(), "unable to set GPIO value");
     }
 }
 
+Expected<void> Gpio::TryVal(Value value) const {
+    return backend_->SetValue((value == kHigh) ? 1 : 0);
+}
+
 Gpio::Value Gpio::Val() const {
-    return (line_.get_value()) ? Value::kHigh : Value::kLow;
+    Expected<Value> result = TryVal();
+    if (!result) {
+        throw std::system_error(result.Error(), "unable to get GPIO value");
+    }
+    return result.Value();
+}
+
+Expected<Gpio::Value> Gpio::TryVal() const {
+    Expected<int> result = backend_->GetValue();
+    if (!result) {
+        return result.Error();
+    }
+    return (result.Value()) ? Value::kHigh : Value::kLow;
 }
 
 void Gpio::EdgeType(Edge edge) {
     dir_ = Direction::kInput;
-
-    switch (edge) {
-        case Edge::kRising:
-            line_.request({name_, gpiod::line_request::EVENT_RISING_EDGE, 0});
-            edge_ = Edge::kRising;
-            break;
-        case Edge::kFalling:
-            line_.request({name_, gpiod::line_request::EVENT_FALLING_EDGE, 0});
-            edge_ = Edge::kFalling;
-            break;
-        case Edge::kBoth:
-            line_.request({name_, gpiod::line_request::EVENT_BOTH_EDGES, 0});
-            edge_ = Edge::kBoth;
-            break;
-        case Edge::kNone:
-            /* gpiod doesn't seem to have a 'none' edge setting. */
-            edge_ = Edge::kNone;
-            break;
-    }
+    backend_->RequestEdge(name_, edge);
+    edge_ = edge;
 }
 
 void Gpio::SetActiveLow(bool is_low) const {
-    if (is_low) {
-        line_.request({name_, gpiod::line::ACTIVE_LOW, 0});
-    } else {
-        line_.request({name_, gpiod::line::ACTIVE_HIGH, 0});
-    }
+    backend_->SetActiveLow(name_, is_low);
 }
 
 void Gpio::ToggleOutput() const {
@@ -80,10 +84,25 @@ void Gpio::ToggleOutput() const {
     }
 }
 
-void Gpio::WaitForEdge() {
-    while (!line_.event_wait(std::chrono::seconds(1))) {
+timespec Gpio::WaitForEdge() {
+    Expected<timespec> result = TryWaitForEdge();
+    if (!result) {
+        throw std::system_error(result.Error(), "unable to wait for GPIO edge");
+    }
+    return result.Value();
+}
+
+Expected<timespec> Gpio::TryWaitForEdge() { return backend_->WaitForEdge(); }
+
+ConcreteBackend ResolveBackend(const Gpio& gpio) {
+    GpioBackend& backend = gpio.Backend();
+    if (auto* vgpio = dynamic_cast<VirtualGpioBackend*>(&backend)) {
+        return vgpio;
+    }
+    if (auto* gpiod = dynamic_cast<GpiodBackend*>(&backend)) {
+        return gpiod;
     }
-    line_.event_read(); /* Consume the line event. */
+    throw std::runtime_error("unknown GPIO backend");
 }
 
 }  // namespace gsync
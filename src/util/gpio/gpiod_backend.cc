@@ -0,0 +1,124 @@
+#include "util/gpio/gpiod_backend.hpp"
+
+#include <time.h>
+
+#include <string>
+#include <system_error>
+
+namespace gsync {
+
+GpiodBackend::GpiodBackend(const std::string& dev, int offset)
+    : chip_(nullptr), line_(nullptr), request_type_(0), active_low_(false) {
+    chip_ = gpiod_chip_open_lookup(dev.c_str());
+    if (!chip_) {
+        throw std::system_error(ErrnoError(),
+                                "unable to open GPIO chip '" + dev + "'");
+    }
+    line_ = gpiod_chip_get_line(chip_, static_cast<unsigned int>(offset));
+    if (!line_) {
+        std::error_code err = ErrnoError();
+        gpiod_chip_close(chip_);
+        throw std::system_error(err, "unable to get GPIO line " +
+                                         std::to_string(offset) + " of '" +
+                                         dev + "'");
+    }
+}
+
+GpiodBackend::~GpiodBackend() {
+    /* Closing the chip releases the line. */
+    gpiod_chip_close(chip_);
+}
+
+std::string GpiodBackend::ChipLabel() const {
+    return gpiod_chip_label(chip_);
+}
+
+std::string GpiodBackend::ChipName() const { return gpiod_chip_name(chip_); }
+
+std::string GpiodBackend::LineName() const {
+    /* Unnamed lines have no name at all. */
+    const char* name = gpiod_line_name(line_);
+    return (name) ? name : "";
+}
+
+unsigned int GpiodBackend::LineOffset() const {
+    return gpiod_line_offset(line_);
+}
+
+void GpiodBackend::Request(const std::string& consumer,
+                           Gpio::Direction direction) {
+    switch (direction) {
+        case Gpio::Direction::kInput:
+            request_type_ = GPIOD_LINE_REQUEST_DIRECTION_INPUT;
+            break;
+        case Gpio::Direction::kOutput:
+            request_type_ = GPIOD_LINE_REQUEST_DIRECTION_OUTPUT;
+            break;
+    }
+    Rerequest(consumer);
+}
+
+void GpiodBackend::RequestEdge(const std::string& consumer, Gpio::Edge edge) {
+    switch (edge) {
+        case Gpio::Edge::kRising:
+            request_type_ = GPIOD_LINE_REQUEST_EVENT_RISING_EDGE;
+            break;
+        case Gpio::Edge::kFalling:
+            request_type_ = GPIOD_LINE_REQUEST_EVENT_FALLING_EDGE;
+            break;
+        case Gpio::Edge::kBoth:
+            request_type_ = GPIOD_LINE_REQUEST_EVENT_BOTH_EDGES;
+            break;
+        case Gpio::Edge::kNone:
+            /* gpiod doesn't seem to have a 'none' edge setting. */
+            return;
+    }
+    Rerequest(consumer);
+}
+
+void GpiodBackend::SetActiveLow(const std::string& consumer, bool is_low) {
+    /* The active low flag is part of the line request. Takes effect right
+     * away on a requested line, otherwise with the next request. */
+    active_low_ = is_low;
+    if (request_type_) {
+        Rerequest(consumer);
+    }
+}
+
+void GpiodBackend::Rerequest(const std::string& consumer) {
+    if (gpiod_line_is_requested(line_)) {
+        gpiod_line_release(line_);
+    }
+
+    const gpiod_line_request_config kConfig = {
+        .consumer = consumer.c_str(),
+        .request_type = request_type_,
+        .flags = (active_low_) ? GPIOD_LINE_REQUEST_FLAG_ACTIVE_LOW : 0,
+    };
+    if (-1 == gpiod_line_request(line_, &kConfig, 0)) {
+        throw std::system_error(ErrnoError(), "unable to request GPIO line " +
+                                                  std::to_string(LineOffset()));
+    }
+}
+
+Expected<timespec> GpiodBackend::WaitForEdge() {
+    const timespec kTimeout = {.tv_sec = 1, .tv_nsec = 0};
+    for (;;) {
+        int ret = gpiod_line_event_wait(line_, &kTimeout);
+        if (-1 == ret) {
+            return ErrnoError();
+        }
+        if (ret) {
+            break;
+        }
+    }
+
+    /* Consume the line event. */
+    gpiod_line_event event;
+    if (-1 == gpiod_line_event_read(line_, &event)) {
+        return ErrnoError();
+    }
+    return event.ts;
+}
+
+}  // namespace gsync
@@ -0,0 +1,233 @@
+#include "util/gpio/vgpio.hpp"
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+
+namespace {
+
+/* The futex word must be a plain, lock free 32-bit integer. */
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t));
+static_assert(std::atomic<uint32_t>::is_always_lock_free);
+static_assert(std::atomic<int64_t>::is_always_lock_free);
+
+const int64_t kNanoPerSec = 1000000000LL;
+
+/* Only the owner may open a bus. Anyone who can open it can drive its lines
+ * and inject edges into the processes on it. */
+const mode_t kBusPerm = 0600;
+
+std::string ShmName(const std::string& bus) { return "/gsync_vgpio_" + bus; }
+
+int64_t EnvNano(const char* name) {
+    const char* str = std::getenv(name);
+    if (!str) {
+        return 0;
+    }
+
+    try {
+        int64_t value = std::stoll(str);
+        if (value >= 0) {
+            return value;
+        }
+    } catch (const std::logic_error& e) {
+    }
+    throw std::runtime_error(std::string(name) +
+                             " must be a non-negative integer");
+}
+
+int64_t NowNano() {
+    timespec now = {};
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec * kNanoPerSec + now.tv_nsec);
+}
+
+uint32_t* FutexWord(std::atomic<uint32_t>& word) {
+    return reinterpret_cast<uint32_t*>(&word);
+}
+
+/* The bus is shared between processes, so no FUTEX_PRIVATE_FLAG. */
+long FutexWait(std::atomic<uint32_t>& word, uint32_t expected,
+               const timespec& timeout) {
+    return syscall(SYS_futex, FutexWord(word), FUTEX_WAIT, expected, &timeout,
+                   nullptr, 0);
+}
+
+void FutexWakeAll(std::atomic<uint32_t>& word) {
+    syscall(SYS_futex, FutexWord(word), FUTEX_WAKE, INT_MAX, nullptr, nullptr,
+            0);
+}
+
+}  // namespace
+
+namespace gsync {
+
+VirtualGpioBackend::VirtualGpioBackend(const std::string& bus, int offset)
+    : bus_(bus),
+      offset_(0),
+      consumer_("unnamed"),
+      mapping_(nullptr),
+      line_(nullptr),
+      edge_(Gpio::Edge::kNone),
+      active_low_(false),
+      seen_rising_(0),
+      seen_falling_(0),
+      delay_ns_(EnvNano("GSYNC_VGPIO_DELAY_NS")),
+      jitter_ns_(EnvNano("GSYNC_VGPIO_JITTER_NS")),
+      rng_(static_cast<std::minstd_rand::result_type>(getpid())) {
+    if ((offset < 0) || (offset >= kMaxLines)) {
+        throw std::runtime_error("vgpio line offset must be in the range [0, " +
+                                 std::to_string(kMaxLines) + ")");
+    }
+    offset_ = static_cast<unsigned int>(offset);
+
+    /* A freshly created bus is zero filled which is a valid, all low, state
+     * for every line. */
+    int fd = shm_open(ShmName(bus_).c_str(), O_CREAT | O_RDWR, kBusPerm);
+    if (-1 == fd) {
+        throw std::runtime_error("unable to open vgpio bus '" + bus_ + "'");
+    }
+    if (-1 == ftruncate(fd, sizeof(Bus))) {
+        close(fd);
+        throw std::runtime_error("unable to size vgpio bus '" + bus_ + "'");
+    }
+    void* addr = mmap(nullptr, sizeof(Bus), PROT_READ | PROT_WRITE,
+                      MAP_SHARED, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) {
+        throw std::runtime_error("unable to map vgpio bus '" + bus_ + "'");
+    }
+    mapping_ = static_cast<Bus*>(addr);
+    line_ = &mapping_->lines[offset_];
+}
+
+VirtualGpioBackend::~VirtualGpioBackend() { munmap(mapping_, sizeof(Bus)); }
+
+bool VirtualGpioBackend::IsVirtual(const std::string& dev) {
+    return (0 == dev.rfind(kDevPrefix, 0));
+}
+
+void VirtualGpioBackend::Unlink(const std::string& bus) {
+    shm_unlink(ShmName(bus).c_str());
+}
+
+void VirtualGpioBackend::Request(const std::string& consumer,
+                                 Gpio::Direction direction) {
+    (void)direction; /* Any process may read or drive a virtual line. */
+    consumer_ = consumer;
+    edge_ = Gpio::Edge::kNone;
+}
+
+void VirtualGpioBackend::RequestEdge(const std::string& consumer,
+                                     Gpio::Edge edge) {
+    consumer_ = consumer;
+    edge_ = edge;
+
+    /* Only edges from here on count. */
+    seen_rising_ = line_->rising.load(std::memory_order_acquire);
+    seen_falling_ = line_->falling.load(std::memory_order_acquire);
+}
+
+void VirtualGpioBackend::SetActiveLow(const std::string& consumer,
+                                      bool is_low) {
+    consumer_ = consumer;
+    active_low_ = is_low;
+}
+
+Expected<void> VirtualGpioBackend::SetValue(int value) {
+    const uint32_t kLevel = ((value != 0) != active_low_) ? 1 : 0;
+    if (kLevel == line_->value.exchange(kLevel, std::memory_order_acq_rel)) {
+        return {};
+    }
+
+    int64_t arrival_ns = NowNano() + delay_ns_;
+    if (jitter_ns_ > 0) {
+        arrival_ns += static_cast<int64_t>(rng_() % (jitter_ns_ + 1));
+    }
+    line_->arrival_ns.store(arrival_ns, std::memory_order_relaxed);
+    if (kLevel) {
+        line_->rising.fetch_add(1, std::memory_order_release);
+    } else {
+        line_->falling.fetch_add(1, std::memory_order_release);
+    }
+    /* Pairs with the waiter registration in WaitForEdge(). Either the waiter
+     * sees the new edge count and doesn't sleep or we see the waiter. */
+    line_->edges.fetch_add(1, std::memory_order_seq_cst);
+    if (line_->waiters.load(std::memory_order_seq_cst)) {
+        FutexWakeAll(line_->edges);
+    }
+    return {};
+}
+
+Expected<int> VirtualGpioBackend::GetValue() const {
+    const bool kLevel = line_->value.load(std::memory_order_acquire);
+    return (kLevel != active_low_) ? 1 : 0;
+}
+
+Expected<timespec> VirtualGpioBackend::WaitForEdge() {
+    /* Active low lines see physical rising edges as falling ones. */
+    bool want_rising = false;
+    bool want_falling = false;
+    switch (edge_) {
+        case Gpio::Edge::kRising:
+            want_rising = !active_low_;
+            want_falling = active_low_;
+            break;
+        case Gpio::Edge::kFalling:
+            want_rising = active_low_;
+            want_falling = !active_low_;
+            break;
+        case Gpio::Edge::kBoth:
+            want_rising = true;
+            want_falling = true;
+            break;
+        case Gpio::Edge::kNone:
+            return std::make_error_code(std::errc::invalid_argument);
+    }
+
+    const timespec kTimeout = {.tv_sec = 1, .tv_nsec = 0};
+    for (;;) {
+        line_->waiters.fetch_add(1, std::memory_order_seq_cst);
+        const uint32_t kEdges = line_->edges.load(std::memory_order_seq_cst);
+        const uint32_t kRising = line_->rising.load(std::memory_order_acquire);
+        const uint32_t kFalling =
+            line_->falling.load(std::memory_order_acquire);
+        const bool kPending = (want_rising && (kRising != seen_rising_)) ||
+                              (want_falling && (kFalling != seen_falling_));
+        seen_rising_ = kRising;
+        seen_falling_ = kFalling;
+        if (kPending) {
+            line_->waiters.fetch_sub(1, std::memory_order_relaxed);
+            break;
+        }
+
+        long ret = FutexWait(line_->edges, kEdges, kTimeout);
+        int err = errno;
+        line_->waiters.fetch_sub(1, std::memory_order_relaxed);
+        if ((-1 == ret) && (err == EINTR)) {
+            return ErrnoError(err);
+        }
+    }
+
+    /* Hold the edge back until its emulated arrival time. */
+    const int64_t kArrival = line_->arrival_ns.load(std::memory_order_relaxed);
+    const timespec kArrivalTs = {
+        .tv_sec = static_cast<time_t>(kArrival / kNanoPerSec),
+        .tv_nsec = static_cast<long>(kArrival % kNanoPerSec),
+    };
+    clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &kArrivalTs, nullptr);
+    return kArrivalTs;
+}
+
+}  // namespace gsync
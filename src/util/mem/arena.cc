@@ -0,0 +1,127 @@
+#include "util/mem/arena.hpp"
+
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+#include "util/mem/mem.hpp"
+
+namespace {
+
+std::size_t RoundUp(std::size_t len, std::size_t multiple) {
+    return ((len + multiple - 1) / multiple) * multiple;
+}
+
+/* Map len bytes aligned to align bytes by over-mapping and trimming the
+ * excess. Transparent huge pages are only used for aligned ranges. */
+void* MapAligned(std::size_t len, std::size_t align) {
+    void* raw = mmap(nullptr, len + align, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED) {
+        return MAP_FAILED;
+    }
+
+    const uintptr_t kRaw = reinterpret_cast<uintptr_t>(raw);
+    const uintptr_t kAligned = RoundUp(kRaw, align);
+    if (kAligned > kRaw) {
+        munmap(raw, kAligned - kRaw);
+    }
+    if (align > (kAligned - kRaw)) {
+        munmap(reinterpret_cast<void*>(kAligned + len),
+               align - (kAligned - kRaw));
+    }
+    return reinterpret_cast<void*>(kAligned);
+}
+
+}  // namespace
+
+gsync::mem::LockedArena::Region::Region(std::size_t len, HugePages huge)
+    : addr(MAP_FAILED), size(0), huge_pages(huge) {
+    if (len == 0) {
+        throw std::runtime_error("arena size must be positive");
+    }
+
+    switch (huge_pages) {
+        case HugePages::kNone:
+            size = RoundUp(len, PageSize());
+            addr = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            break;
+        case HugePages::kTransparent:
+            size = RoundUp(len, HugePageSize());
+            addr = MapAligned(size, HugePageSize());
+            if ((addr != MAP_FAILED) &&
+                (-1 == madvise(addr, size, MADV_HUGEPAGE))) {
+                munmap(addr, size);
+                throw std::runtime_error(
+                    "failed to enable transparent huge pages via madvise()");
+            }
+            break;
+        case HugePages::kExplicit:
+            size = RoundUp(len, HugePageSize());
+            addr = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            break;
+    }
+    if (addr == MAP_FAILED) {
+        const std::string kHint = (huge_pages == HugePages::kExplicit)
+                                      ? " (are vm.nr_hugepages reserved?)"
+                                      : "";
+        throw std::runtime_error("failed to map " + std::to_string(size) +
+                                 " arena bytes via mmap()" + kHint);
+    }
+
+    /* mlock() faults in every page of the region before returning. */
+    if (-1 == mlock(addr, size)) {
+        munmap(addr, size);
+        throw std::runtime_error("failed to lock arena pages via mlock()");
+    }
+}
+
+gsync::mem::LockedArena::Region::~Region() { munmap(addr, size); }
+
+gsync::mem::LockedArena::LockedArena(std::size_t size, Strategy strategy,
+                                     HugePages huge_pages)
+    : region_(size, huge_pages),
+      strategy_(strategy),
+      monotonic_(region_.addr, region_.size,
+                 std::pmr::null_memory_resource()),
+      pool_(),
+      resource_(&monotonic_),
+      in_use_(0),
+      peak_in_use_(0) {
+    if (strategy_ == Strategy::kPool) {
+        /* The pools carve their chunks, and their bookkeeping, out of the
+         * bump allocator. */
+        pool_.emplace(&monotonic_);
+        resource_ = &pool_.value();
+    }
+}
+
+gsync::mem::LockedArena::~LockedArena() {
+    /* The pools' bookkeeping lives in the region, release it before the
+     * region is unmapped. */
+    pool_.reset();
+}
+
+void* gsync::mem::LockedArena::do_allocate(std::size_t bytes,
+                                           std::size_t alignment) {
+    void* p = resource_->allocate(bytes, alignment);
+    in_use_ += bytes;
+    peak_in_use_ = std::max(peak_in_use_, in_use_);
+    return p;
+}
+
+void gsync::mem::LockedArena::do_deallocate(void* p, std::size_t bytes,
+                                            std::size_t alignment) {
+    resource_->deallocate(p, bytes, alignment);
+    in_use_ -= bytes;
+}
+
+bool gsync::mem::LockedArena::do_is_equal(
+    const std::pmr::memory_resource& other) const noexcept {
+    return (this == &other);
+}
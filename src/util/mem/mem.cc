@@ -1,19 +1,189 @@
 #include "util/mem/mem.hpp"
 
+#include <alloca.h>
+#include <errno.h>
 #include <malloc.h>
 #include <sys/mman.h>
+#include <sys/resource.h>
 #include <unistd.h>
 
-#include <array>
+#include <algorithm>
+#include <cctype>
 #include <cstdint>
 #include <cstdlib>
-#include <memory>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <new>
 #include <stdexcept>
+#include <string>
 
-void gsync::mem::ConfigureMallocForRt() {
-    /* Lock all pages to RAM. */
-    if (-1 == mlockall(MCL_CURRENT | MCL_FUTURE)) {
-        throw std::runtime_error("failed to lock memory pages via mlockall()");
+namespace {
+
+std::size_t Margin(std::size_t peak) {
+    return std::max(
+        static_cast<std::size_t>(peak * gsync::mem::kAutoMarginFraction),
+        static_cast<std::size_t>(gsync::mem::kMinAutoMargin));
+}
+
+/* Return a size in bytes from a "<key> <size> kB" line of a /proc file. */
+std::size_t ReadProcKib(const std::string& path, const std::string& key) {
+    std::ifstream proc(path);
+    std::string field;
+    while (proc >> field) {
+        if (field == key) {
+            std::size_t kib = 0;
+            proc >> kib;
+            return kib * 1024;
+        }
+        proc.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+    }
+    throw std::runtime_error("failed to read " + key + " from " + path);
+}
+
+/* Return the size of the main thread's stack mapping in bytes. */
+std::size_t StackVmSize() {
+    return ReadProcKib("/proc/self/status", "VmStk:");
+}
+
+/* Return the address just past the top of the main thread's stack. */
+uintptr_t StackTop() {
+    std::ifstream maps("/proc/self/maps");
+    std::string line;
+    while (std::getline(maps, line)) {
+        if (line.find("[stack]") == std::string::npos) {
+            continue;
+        }
+        const std::size_t kDash = line.find('-');
+        if (kDash == std::string::npos) {
+            break;
+        }
+        return static_cast<uintptr_t>(
+            std::stoull(line.substr(kDash + 1), nullptr, 16));
+    }
+    throw std::runtime_error("failed to find the stack in /proc/self/maps");
+}
+
+/* Return the number of bytes the main malloc arena got from the system. */
+std::size_t HeapArenaSize() {
+#if defined(__GLIBC__) && \
+    ((__GLIBC__ > 2) || ((__GLIBC__ == 2) && (__GLIBC_MINOR__ >= 33)))
+    return mallinfo2().arena;
+#else
+    /* mallinfo() fields are ints and overflow past 2GiB. That's way more heap
+     * than we'd ever want to lock. */
+    return static_cast<std::size_t>(mallinfo().arena);
+#endif
+}
+
+}  // namespace
+
+std::size_t gsync::mem::PageSize() {
+    static const std::size_t kPageSize =
+        static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    return kPageSize;
+}
+
+std::size_t gsync::mem::HugePageSize() {
+    static const std::size_t kHugePageSize =
+        ReadProcKib("/proc/meminfo", "Hugepagesize:");
+    return kHugePageSize;
+}
+
+gsync::mem::LockPolicy gsync::mem::ParseLockPolicy(const std::string& str) {
+    if (str == "all") {
+        return LockPolicy::kAll;
+    } else if (str == "onfault") {
+        return LockPolicy::kOnFault;
+    } else if (str == "regions") {
+        return LockPolicy::kRegions;
+    }
+    throw std::runtime_error("lock policy must be one of all, onfault or "
+                             "regions");
+}
+
+void gsync::mem::LockRegion(const void* addr, std::size_t len) {
+    const uintptr_t kPageMask = ~static_cast<uintptr_t>(PageSize() - 1);
+    const uintptr_t kStart = reinterpret_cast<uintptr_t>(addr) & kPageMask;
+    const uintptr_t kEnd =
+        (reinterpret_cast<uintptr_t>(addr) + len + PageSize() - 1) &
+        kPageMask;
+    if (-1 == mlock(reinterpret_cast<const void*>(kStart), kEnd - kStart)) {
+        throw std::runtime_error("failed to lock " +
+                                 std::to_string(kEnd - kStart) +
+                                 " bytes via mlock()");
+    }
+}
+
+void gsync::mem::LockHeap() {
+    /* With mmap() disabled, the main arena is the one contiguous run of
+     * memory below the program break. */
+    const char* brk = static_cast<const char*>(sbrk(0));
+    const std::size_t kArena = HeapArenaSize();
+    LockRegion(brk - kArena, kArena);
+}
+
+std::size_t gsync::mem::LockedBytes() {
+    return ReadProcKib("/proc/self/status", "VmLck:");
+}
+
+std::size_t gsync::mem::ResidentBytes() {
+    return ReadProcKib("/proc/self/status", "VmRSS:");
+}
+
+std::size_t gsync::mem::ParseSize(const std::string& str) {
+    std::size_t pos = 0;
+    unsigned long long size = 0;
+    try {
+        size = std::stoull(str, &pos);
+    } catch (const std::logic_error& e) {
+        throw std::runtime_error("invalid memory size '" + str + "'");
+    }
+
+    std::size_t shift = 0;
+    if (pos < str.size()) {
+        switch (std::toupper(static_cast<unsigned char>(str[pos]))) {
+            case 'K':
+                shift = 10;
+                break;
+            case 'M':
+                shift = 20;
+                break;
+            case 'G':
+                shift = 30;
+                break;
+            default:
+                throw std::runtime_error("invalid memory size '" + str + "'");
+        }
+        ++pos;
+    }
+    if ((pos != str.size()) || (size > (SIZE_MAX >> shift))) {
+        throw std::runtime_error("invalid memory size '" + str + "'");
+    }
+    return static_cast<std::size_t>(size << shift);
+}
+
+void gsync::mem::ConfigureMallocForRt(LockPolicy policy) {
+    /* Lock pages to RAM. */
+    switch (policy) {
+        case LockPolicy::kAll:
+            if (-1 == mlockall(MCL_CURRENT | MCL_FUTURE)) {
+                throw std::runtime_error(
+                    "failed to lock memory pages via mlockall()");
+            }
+            break;
+        case LockPolicy::kOnFault:
+#ifdef MCL_ONFAULT
+            if (-1 == mlockall(MCL_CURRENT | MCL_FUTURE | MCL_ONFAULT)) {
+                throw std::runtime_error(
+                    "failed to lock memory pages via mlockall(MCL_ONFAULT)");
+            }
+            break;
+#else
+            throw std::runtime_error("MCL_ONFAULT is not supported");
+#endif
+        case LockPolicy::kRegions:
+            break;
     }
 
     /* Disable heap trimming. */
@@ -29,26 +199,131 @@ void gsync::mem::ConfigureMallocForRt() {
     }
 }
 
-void gsync::mem::PrefaultStack() {
-    std::array<unsigned char, kMaxStackSize> dummy = {0};
-    for (int64_t i = 0; i < kMaxStackSize; i += sysconf(_SC_PAGESIZE)) {
-        dummy.at(i) = 1;
+void gsync::mem::PrefaultStack(std::size_t size, bool lock) {
+    /* Leave room for the frames already on the stack. */
+    rlimit limit = {};
+    if (-1 == getrlimit(RLIMIT_STACK, &limit)) {
+        throw std::runtime_error("failed to read RLIMIT_STACK");
+    }
+    if ((limit.rlim_cur != RLIM_INFINITY) &&
+        ((size + kMinAutoMargin) > limit.rlim_cur)) {
+        throw std::runtime_error("stack prefault size " +
+                                 std::to_string(size) +
+                                 " exceeds RLIMIT_STACK");
+    }
+
+    /* The size counts from the top of the stack, so the frames already on it
+     * count towards it. Only the part below them needs to be faulted in. The
+     * stores go through a volatile pointer so that they aren't optimized
+     * away. */
+    const uintptr_t kTop = StackTop();
+    volatile unsigned char depth_marker = 0;
+    const std::size_t kDepth =
+        kTop - reinterpret_cast<uintptr_t>(&depth_marker);
+    if (size > kDepth) {
+        volatile unsigned char* dummy =
+            static_cast<volatile unsigned char*>(alloca(size - kDepth));
+        const std::size_t kPageSize = PageSize();
+        for (std::size_t i = 0; i < (size - kDepth); i += kPageSize) {
+            dummy[i] = 1;
+        }
+    }
+
+    if (lock) {
+        LockRegion(reinterpret_cast<const void*>(kTop - size), size);
+    }
+}
+
+void gsync::mem::PrefaultHeap(std::size_t size, bool lock) {
+    /* A single allocation of size bytes could be served by chunks the arena
+     * already freed, leaving the pages past the arena's top untouched. Keep
+     * allocating until a chunk reaches size bytes past the arena's base,
+     * touching every chunk on the way. The chunks are chained through their
+     * first bytes so that all of them can be freed afterwards. */
+    const std::size_t kPageSize = PageSize();
+    const uintptr_t kBase =
+        reinterpret_cast<uintptr_t>(sbrk(0)) - HeapArenaSize();
+    unsigned char* chain = nullptr;
+    uintptr_t end = kBase;
+    while (end < (kBase + size)) {
+        const std::size_t kChunkSize =
+            std::max(static_cast<std::size_t>(kBase + size - end), kPageSize);
+        unsigned char* chunk = new (std::nothrow) unsigned char[kChunkSize];
+        if (!chunk) {
+            break;
+        }
+        volatile unsigned char* pages = chunk;
+        for (std::size_t i = 0; i < kChunkSize; i += kPageSize) {
+            pages[i] = 1;
+        }
+        pages[kChunkSize - 1] = 1;
+
+        std::memcpy(chunk, &chain, sizeof(chain));
+        chain = chunk;
+        end = std::max(end, reinterpret_cast<uintptr_t>(chunk) + kChunkSize);
+    }
+    while (chain) {
+        unsigned char* next = nullptr;
+        std::memcpy(&next, chain, sizeof(next));
+        delete[] chain;
+        chain = next;
+    }
+    if (end < (kBase + size)) {
+        throw std::runtime_error("failed to allocate " +
+                                 std::to_string(size) + " heap bytes");
+    }
+
+    /* Trimming is disabled, so the pages stay in the heap after the chunks
+     * are freed. */
+    if (lock) {
+        LockHeap();
     }
 }
 
-void gsync::mem::PrefaultHeap() {
-    std::unique_ptr<unsigned char[]> dummy(new unsigned char[kMaxHeapSize]);
-    if (!dummy) {
-        throw std::runtime_error("failed to allocate kMaxHeapSize bytes");
+gsync::mem::Usage gsync::mem::PeakUsage() {
+    return {
+        .stack_bytes = StackVmSize(),
+        .heap_bytes = HeapArenaSize(),
+    };
+}
+
+gsync::mem::Usage gsync::mem::PrefaultMeasured(const Config& config) {
+    const Usage kPeak = PeakUsage();
+
+    /* Both prefaults count from the base of their region, so the pages the
+     * warm-up touched are skipped over and only the margin past the peak is
+     * faulted in. Without mlockall(), the whole amount is locked by hand. */
+    const bool kLock = (config.lock == LockPolicy::kRegions);
+    Usage prefaulted;
+    if (!config.stack_size) {
+        prefaulted.stack_bytes =
+            kPeak.stack_bytes + Margin(kPeak.stack_bytes);
+        PrefaultStack(prefaulted.stack_bytes, kLock);
+    }
+    if (!config.heap_size) {
+        prefaulted.heap_bytes = kPeak.heap_bytes + Margin(kPeak.heap_bytes);
+        PrefaultHeap(prefaulted.heap_bytes, kLock);
     }
+    return prefaulted;
+}
 
-    for (int64_t i = 0; i < kMaxHeapSize; i += sysconf(_SC_PAGESIZE)) {
-        dummy[i] = 1;
+gsync::Expected<gsync::mem::Usage> gsync::mem::TryPrefaultMeasured(
+    const Config& config) {
+    errno = 0;
+    try {
+        return PrefaultMeasured(config);
+    } catch (const std::exception&) {
+        return ErrnoError((errno) ? errno : EIO);
     }
 }
 
-void gsync::mem::ConfigureMemForRt() {
-    ConfigureMallocForRt();
-    PrefaultStack();
-    PrefaultHeap();
+void gsync::mem::ConfigureMemForRt(const Config& config) {
+    const bool kLock = (config.lock == LockPolicy::kRegions);
+    ConfigureMallocForRt(config.lock);
+    if (config.stack_size) {
+        PrefaultStack(*config.stack_size, kLock);
+    }
+    if (config.heap_size) {
+        PrefaultHeap(*config.heap_size, kLock);
+    }
 }
@@ -0,0 +1,37 @@
+#include "util/perf/histogram.hpp"
+
+#include <cmath>
+
+namespace gsync {
+
+int64_t LatencyHistogram::Percentile(double p) const {
+    if (!count_) {
+        return 0;
+    }
+    p = (p < 0.0) ? 0.0 : ((p > 1.0) ? 1.0 : p);
+    uint64_t rank = static_cast<uint64_t>(
+        std::ceil(p * static_cast<double>(count_)));
+    rank = (rank) ? rank : 1;
+
+    uint64_t seen = 0;
+    for (std::size_t i = 0; i < kNumBuckets; ++i) {
+        seen += buckets_[i];
+        if (seen < rank) {
+            continue;
+        }
+        /* Upper edge of bucket i. The last bucket has no upper edge. */
+        int64_t edge = max_;
+        if (i < static_cast<std::size_t>(kSubBuckets)) {
+            edge = static_cast<int64_t>(i);
+        } else if (i < (kNumBuckets - 1)) {
+            int64_t octave =
+                static_cast<int64_t>(i - kSubBuckets) / kSubBuckets;
+            int64_t sub = static_cast<int64_t>(i - kSubBuckets) % kSubBuckets;
+            edge = ((kSubBuckets + sub + 1) << octave) - 1;
+        }
+        return (edge < max_) ? edge : max_;
+    }
+    return max_;
+}
+
+}  // namespace gsync
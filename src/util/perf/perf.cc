@@ -0,0 +1,225 @@
+#include "util/perf/perf.hpp"
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+/* Encode a PERF_TYPE_HW_CACHE config, see man 2 perf_event_open. */
+constexpr uint64_t HwCache(uint64_t cache, uint64_t op, uint64_t result) {
+    return (cache | (op << 8) | (result << 16));
+}
+
+void Configure(gsync::PerfCounter::Event event, perf_event_attr& attr) {
+    using Event = gsync::PerfCounter::Event;
+    switch (event) {
+        case Event::kCycles:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_CPU_CYCLES;
+            break;
+        case Event::kInstructions:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+            break;
+        case Event::kCacheMisses:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_CACHE_MISSES;
+            break;
+        case Event::kDtlbReadMisses:
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config =
+                HwCache(PERF_COUNT_HW_CACHE_DTLB, PERF_COUNT_HW_CACHE_OP_READ,
+                        PERF_COUNT_HW_CACHE_RESULT_MISS);
+            break;
+        case Event::kDtlbWriteMisses:
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config =
+                HwCache(PERF_COUNT_HW_CACHE_DTLB, PERF_COUNT_HW_CACHE_OP_WRITE,
+                        PERF_COUNT_HW_CACHE_RESULT_MISS);
+            break;
+        case Event::kItlbReadMisses:
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config =
+                HwCache(PERF_COUNT_HW_CACHE_ITLB, PERF_COUNT_HW_CACHE_OP_READ,
+                        PERF_COUNT_HW_CACHE_RESULT_MISS);
+            break;
+        case Event::kBranchMisses:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+            break;
+        case Event::kContextSwitches:
+            attr.type = PERF_TYPE_SOFTWARE;
+            attr.config = PERF_COUNT_SW_CONTEXT_SWITCHES;
+            break;
+    }
+}
+
+/* Size of the counter's metadata page mapping. No ring buffer follows it. */
+std::size_t PageSize() { return static_cast<std::size_t>(getpagesize()); }
+
+}  // namespace
+
+namespace gsync {
+
+PerfCounter::PerfCounter(Event event)
+    : event_(event), fd_(-1), page_(nullptr) {
+    perf_event_attr attr = {};
+    attr.size = sizeof(attr);
+    Configure(event_, attr);
+    attr.disabled = 1;
+    attr.exclude_hv = 1;
+
+    /* Hardware events only count user space. That keeps them open to
+     * unprivileged users at the default kernel.perf_event_paranoid of 2, and
+     * keeps the read() system calls made for the other counters out of their
+     * counts. Context switches happen in the kernel, so that one software
+     * event still counts it. */
+    attr.exclude_kernel = (attr.type != PERF_TYPE_SOFTWARE);
+
+    /* Count the calling thread on whichever CPU it runs on. */
+    fd_ = static_cast<int>(
+        syscall(SYS_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC));
+    if (fd_ == -1) {
+        throw std::runtime_error(std::string("failed to open ") +
+                                 Name(event_) + " counter: " +
+                                 std::strerror(errno));
+    }
+
+    /* Without the metadata page, ReadFast() falls back to read(). */
+    void* page = mmap(nullptr, PageSize(), PROT_READ, MAP_SHARED, fd_, 0);
+    if (page != MAP_FAILED) {
+        page_ = static_cast<perf_event_mmap_page*>(page);
+    }
+}
+
+PerfCounter::~PerfCounter() {
+    if (page_) {
+        munmap(page_, PageSize());
+    }
+    if (fd_ != -1) {
+        close(fd_);
+    }
+}
+
+PerfCounter::PerfCounter(PerfCounter&& other) noexcept
+    : event_(other.event_), fd_(other.fd_), page_(other.page_) {
+    other.fd_ = -1;
+    other.page_ = nullptr;
+}
+
+PerfCounter& PerfCounter::operator=(PerfCounter&& other) noexcept {
+    if (this != &other) {
+        if (page_) {
+            munmap(page_, PageSize());
+        }
+        if (fd_ != -1) {
+            close(fd_);
+        }
+        event_ = other.event_;
+        fd_ = other.fd_;
+        page_ = other.page_;
+        other.fd_ = -1;
+        other.page_ = nullptr;
+    }
+    return *this;
+}
+
+void PerfCounter::Enable() { ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0); }
+
+void PerfCounter::Disable() { ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0); }
+
+void PerfCounter::Reset() { ioctl(fd_, PERF_EVENT_IOC_RESET, 0); }
+
+uint64_t PerfCounter::Read() const {
+    uint64_t count = 0;
+    if (static_cast<ssize_t>(sizeof(count)) !=
+        read(fd_, &count, sizeof(count))) {
+        throw std::runtime_error(std::string("failed to read ") +
+                                 Name(event_) + " counter");
+    }
+    return count;
+}
+
+uint64_t PerfCounter::ReadFast() const noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+    /* The kernel updates the page under a sequence count whenever the
+     * counter is scheduled in or out. Retry if that happened mid-read. See
+     * the perf_event_mmap_page comments in linux/perf_event.h. */
+    if (page_) {
+        const volatile perf_event_mmap_page* page = page_;
+        uint64_t count = 0;
+        uint32_t seq = 0;
+        bool direct = true;
+        do {
+            seq = page->lock;
+            std::atomic_signal_fence(std::memory_order_seq_cst);
+            uint32_t index = page->index;
+            if (!page->cap_user_rdpmc || !index) {
+                direct = false;
+                break;
+            }
+            /* The hardware counter is pmc_width bits wide, sign extend it. */
+            uint16_t shift = static_cast<uint16_t>(64 - page->pmc_width);
+            int64_t pmc = static_cast<int64_t>(
+                static_cast<uint64_t>(__rdpmc(static_cast<int>(index - 1)))
+                << shift);
+            count = static_cast<uint64_t>(page->offset + (pmc >> shift));
+            std::atomic_signal_fence(std::memory_order_seq_cst);
+        } while (page->lock != seq);
+        if (direct) {
+            return count;
+        }
+    }
+#endif
+    uint64_t count = 0;
+    if (static_cast<ssize_t>(sizeof(count)) !=
+        read(fd_, &count, sizeof(count))) {
+        return 0;
+    }
+    return count;
+}
+
+bool PerfCounter::UserReadable() const {
+#if defined(__x86_64__) || defined(__i386__)
+    return page_ && page_->cap_user_rdpmc && page_->index;
+#else
+    return false;
+#endif
+}
+
+const char* PerfCounter::Name(Event event) {
+    switch (event) {
+        case Event::kCycles:
+            return "cycles";
+        case Event::kInstructions:
+            return "instructions";
+        case Event::kCacheMisses:
+            return "cache_misses";
+        case Event::kDtlbReadMisses:
+            return "dtlb_read_misses";
+        case Event::kDtlbWriteMisses:
+            return "dtlb_write_misses";
+        case Event::kItlbReadMisses:
+            return "itlb_read_misses";
+        case Event::kBranchMisses:
+            return "branch_misses";
+        case Event::kContextSwitches:
+            return "context_switches";
+    }
+    return "unknown";
+}
+
+}  // namespace gsync
@@ -0,0 +1,43 @@
+#include "util/perf/sections.hpp"
+
+#include <stdexcept>
+
+namespace gsync {
+
+SectionCounters::SectionCounters(
+    std::initializer_list<PerfCounter::Event> events)
+    : counters_(), skipped_(), start_(), stats_() {
+    if (events.size() > kMaxEvents) {
+        throw std::runtime_error("too many section counter events");
+    }
+    counters_.reserve(events.size());
+    for (PerfCounter::Event event : events) {
+        try {
+            counters_.emplace_back(event);
+        } catch (const std::runtime_error& e) {
+            skipped_.emplace_back(e.what());
+        }
+    }
+    if (counters_.empty()) {
+        throw std::runtime_error("no section counter events could be opened");
+    }
+    for (PerfCounter& counter : counters_) {
+        counter.Enable();
+    }
+}
+
+bool SectionCounters::UserReadable() const {
+    bool any_hardware = false;
+    for (const PerfCounter& counter : counters_) {
+        if (counter.CountedEvent() == PerfCounter::Event::kContextSwitches) {
+            continue;
+        }
+        if (!counter.UserReadable()) {
+            return false;
+        }
+        any_hardware = true;
+    }
+    return any_hardware;
+}
+
+}  // namespace gsync
@@ -0,0 +1,174 @@
+#include "util/sched/sched.hpp"
+
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+/* Older C libraries don't expose SCHED_DEADLINE or sched_setattr(). */
+#ifndef SCHED_DEADLINE
+#define SCHED_DEADLINE 6
+#endif
+
+namespace {
+
+/* See man 2 sched_setattr. */
+struct SchedAttr {
+    uint32_t size;
+    uint32_t sched_policy;
+    uint64_t sched_flags;
+    int32_t sched_nice;
+    uint32_t sched_priority;
+    uint64_t sched_runtime;
+    uint64_t sched_deadline;
+    uint64_t sched_period;
+};
+
+int SchedSetAttr(const SchedAttr& attr) {
+    return static_cast<int>(
+        syscall(SYS_sched_setattr, 0, &attr, static_cast<unsigned int>(0)));
+}
+
+int SchedGetAttr(SchedAttr& attr) {
+    return static_cast<int>(syscall(SYS_sched_getattr, 0, &attr,
+                                    static_cast<unsigned int>(sizeof(attr)),
+                                    static_cast<unsigned int>(0)));
+}
+
+std::runtime_error ErrnoError(const std::string& what) {
+    return std::runtime_error(what + ": " + std::strerror(errno));
+}
+
+}  // namespace
+
+void gsync::sched::MoveToCpuset(const std::string& cgroup_dir) {
+    /* Try the cgroup v2 interface first and fall back to v1. */
+    for (const char* iface : {"/cgroup.procs", "/tasks"}) {
+        std::ofstream procs(cgroup_dir + iface);
+        if (!procs) {
+            continue;
+        }
+        procs << getpid() << std::endl;
+        if (!procs) {
+            throw std::runtime_error("failed to move into cgroup '" +
+                                     cgroup_dir + "'");
+        }
+        return;
+    }
+    throw std::runtime_error("unable to open cgroup '" + cgroup_dir + "'");
+}
+
+void gsync::sched::SetCpuAffinity(int cpu) {
+    if (cpu < 0 || cpu >= CPU_SETSIZE) {
+        throw std::runtime_error("invalid cpu " + std::to_string(cpu));
+    }
+
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(cpu, &cpus);
+    if (-1 == sched_setaffinity(0, sizeof(cpus), &cpus)) {
+        throw ErrnoError("failed to pin to cpu " + std::to_string(cpu) +
+                         " via sched_setaffinity()");
+    }
+}
+
+void gsync::sched::SetFifo(int priority) {
+    if (priority < sched_get_priority_min(SCHED_FIFO) ||
+        priority > sched_get_priority_max(SCHED_FIFO)) {
+        throw std::runtime_error("invalid SCHED_FIFO priority " +
+                                 std::to_string(priority));
+    }
+
+    sched_param param = {};
+    param.sched_priority = priority;
+    if (-1 == sched_setscheduler(0, SCHED_FIFO, &param)) {
+        throw ErrnoError("failed to set SCHED_FIFO via sched_setscheduler()");
+    }
+}
+
+void gsync::sched::SetDeadline(uint64_t runtime_ns, uint64_t deadline_ns,
+                               uint64_t period_ns) {
+    if (!runtime_ns || (runtime_ns > deadline_ns) ||
+        (deadline_ns > period_ns)) {
+        throw std::runtime_error(
+            "SCHED_DEADLINE requires 0 < runtime <= deadline <= period");
+    }
+
+    SchedAttr attr = {};
+    attr.size = sizeof(attr);
+    attr.sched_policy = SCHED_DEADLINE;
+    attr.sched_runtime = runtime_ns;
+    attr.sched_deadline = deadline_ns;
+    attr.sched_period = period_ns;
+    if (-1 == SchedSetAttr(attr)) {
+        throw ErrnoError(
+            "failed to set SCHED_DEADLINE via sched_setattr() (note, the "
+            "task's affinity must span its whole root domain)");
+    }
+}
+
+std::string gsync::sched::DescribeSched() {
+    SchedAttr attr = {};
+    if (-1 == SchedGetAttr(attr)) {
+        throw ErrnoError("failed to read policy via sched_getattr()");
+    }
+
+    switch (attr.sched_policy) {
+        case SCHED_FIFO:
+            return "SCHED_FIFO priority " +
+                   std::to_string(attr.sched_priority);
+        case SCHED_RR:
+            return "SCHED_RR priority " + std::to_string(attr.sched_priority);
+        case SCHED_DEADLINE:
+            return "SCHED_DEADLINE runtime " +
+                   std::to_string(attr.sched_runtime) + "ns deadline " +
+                   std::to_string(attr.sched_deadline) + "ns period " +
+                   std::to_string(attr.sched_period) + "ns";
+        case SCHED_OTHER:
+            return "SCHED_OTHER nice " + std::to_string(attr.sched_nice);
+        default:
+            return "policy " + std::to_string(attr.sched_policy);
+    }
+}
+
+bool gsync::sched::IsRealTime() {
+    SchedAttr attr = {};
+    if (-1 == SchedGetAttr(attr)) {
+        return false;
+    }
+    return ((attr.sched_policy == SCHED_FIFO) ||
+            (attr.sched_policy == SCHED_RR) ||
+            (attr.sched_policy == SCHED_DEADLINE));
+}
+
+void gsync::sched::ConfigureSchedForRt(const Config& config) {
+    /* The kernel refuses to admit a task whose affinity is narrower than its
+     * root domain, check before changing anything. */
+    if ((config.cpu >= 0) && (config.policy == Policy::kDeadline)) {
+        throw std::runtime_error(
+            "SCHED_DEADLINE tasks can't be pinned to a CPU, use a cpuset");
+    }
+    if (!config.cpuset.empty()) {
+        MoveToCpuset(config.cpuset);
+    }
+    if (config.cpu >= 0) {
+        SetCpuAffinity(config.cpu);
+    }
+
+    switch (config.policy) {
+        case Policy::kInherit:
+            break;
+        case Policy::kFifo:
+            SetFifo(config.priority);
+            break;
+        case Policy::kDeadline:
+            SetDeadline(config.runtime_ns, config.deadline_ns,
+                        config.period_ns);
+            break;
+    }
+}
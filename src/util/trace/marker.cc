@@ -0,0 +1,122 @@
+#include "util/trace/marker.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+/* Appends to a fixed size buffer, silently truncating. Nothing here may
+ * allocate, so no snprintf() and its locale handling either. */
+class Formatter {
+   public:
+    Formatter() : buffer_{}, length_(0) {}
+
+    void Append(const char* str) {
+        while (*str && (length_ < buffer_.size())) {
+            buffer_[length_++] = *str++;
+        }
+    }
+
+    void Append(char c) {
+        if (length_ < buffer_.size()) {
+            buffer_[length_++] = c;
+        }
+    }
+
+    void Append(int64_t value) {
+        /* Work in the negative range so that INT64_MIN doesn't overflow. */
+        std::array<char, 20> digits = {};
+        std::size_t num_digits = 0;
+        bool negative = (value < 0);
+        if (!negative) {
+            value = -value;
+        }
+        do {
+            digits[num_digits++] = static_cast<char>('0' - (value % 10));
+            value /= 10;
+        } while (value);
+        if (negative) {
+            Append('-');
+        }
+        while (num_digits) {
+            Append(digits[--num_digits]);
+        }
+    }
+
+    const char* Data() const { return buffer_.data(); }
+
+    std::size_t Length() const { return length_; }
+
+   private:
+    std::array<char, gsync::TraceMarker::kMaxLength> buffer_;
+    std::size_t length_;
+};
+
+/* Open trace_marker for writing, returning -1 and leaving errno set on
+ * failure. */
+int OpenMarker(const std::string& path) {
+    return open(path.c_str(), O_WRONLY | O_CLOEXEC);
+}
+
+}  // namespace
+
+namespace gsync {
+
+TraceMarker::TraceMarker(const std::string& tag, const std::string& path)
+    : prefix_(tag + "[" + std::to_string(getpid()) + "] "),
+      path_(path),
+      fd_(-1),
+      written_(0),
+      failed_(0) {
+    if (path_.empty()) {
+        for (const char* tracefs :
+             {"/sys/kernel/tracing", "/sys/kernel/debug/tracing"}) {
+            path_ = std::string(tracefs) + "/trace_marker";
+            fd_ = OpenMarker(path_);
+            if (fd_ != -1) {
+                break;
+            }
+        }
+    } else {
+        fd_ = OpenMarker(path_);
+    }
+    if (fd_ == -1) {
+        throw std::runtime_error("failed to open " + path_ + ": " +
+                                 std::strerror(errno));
+    }
+}
+
+TraceMarker::~TraceMarker() {
+    if (fd_ != -1) {
+        close(fd_);
+    }
+}
+
+Expected<void> TraceMarker::Mark(const char* event,
+                                 std::initializer_list<Field> fields) noexcept {
+    Formatter marker;
+    marker.Append(prefix_.c_str());
+    marker.Append(event);
+    for (const Field& field : fields) {
+        marker.Append(' ');
+        marker.Append(field.key);
+        marker.Append('=');
+        marker.Append(field.value);
+    }
+
+    /* The kernel appends the newline. */
+    if (write(fd_, marker.Data(), marker.Length()) == -1) {
+        failed_++;
+        return ErrnoError();
+    }
+    written_++;
+    return {};
+}
+
+}  // namespace gsync
@@ -0,0 +1,182 @@
+#include "util/tripwire/tripwire.hpp"
+
+#include <execinfo.h>
+#include <malloc.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+
+/* glibc's own allocator entry points. Forwarding to these rather than looking
+ * up the next malloc() with dlsym() avoids dlsym() allocating on the very first
+ * call. */
+extern "C" {
+void* __libc_malloc(std::size_t size);
+void* __libc_calloc(std::size_t nmemb, std::size_t size);
+void* __libc_realloc(void* ptr, std::size_t size);
+void* __libc_memalign(std::size_t alignment, std::size_t size);
+void __libc_free(void* ptr);
+}
+
+namespace {
+
+const int kMaxFrames = 32;
+
+static_assert(std::atomic<bool>::is_always_lock_free);
+std::atomic_bool armed = false;
+
+std::atomic<uint64_t> allocations = 0;
+std::atomic<uint64_t> frees = 0;
+std::atomic<uint64_t> minor_faults = 0;
+std::atomic<uint64_t> major_faults = 0;
+
+/* Fault counts at the last check. */
+long last_minflt = 0;
+long last_majflt = 0;
+
+/* Set while reporting so that allocations made by the report itself aren't
+ * reported. */
+thread_local bool reporting = false;
+
+void Report(const char* what, std::size_t value) {
+    reporting = true;
+
+    /* Stick to stack buffers and raw writes, the heap is what we're
+     * policing. */
+    char msg[128] = {0};
+    int len = std::snprintf(msg, sizeof(msg),
+                            "tripwire: %s (%zu) in the armed section\n", what,
+                            value);
+    if (len > 0) {
+        ssize_t ret = write(STDERR_FILENO, msg, static_cast<std::size_t>(len));
+        (void)ret;
+    }
+
+    void* frames[kMaxFrames] = {};
+    int depth = backtrace(static_cast<void**>(frames), kMaxFrames);
+    backtrace_symbols_fd(static_cast<void**>(frames), depth, STDERR_FILENO);
+
+#ifndef NDEBUG
+    std::abort();
+#endif
+
+    reporting = false;
+}
+
+void TripAlloc(const char* what, std::size_t size) {
+    if (armed.load(std::memory_order_relaxed) && !reporting) {
+        allocations++;
+        Report(what, size);
+    }
+}
+
+void ReadFaults(long& minflt, long& majflt) {
+    rusage usage = {};
+    getrusage(RUSAGE_THREAD, &usage);
+    minflt = usage.ru_minflt;
+    majflt = usage.ru_majflt;
+}
+
+}  // namespace
+
+void gsync::tripwire::Arm() {
+    /* backtrace() loads libgcc on its first call, which allocates. Get that
+     * out of the way before arming. */
+    void* frames[kMaxFrames] = {};
+    backtrace(static_cast<void**>(frames), kMaxFrames);
+
+    ReadFaults(last_minflt, last_majflt);
+    armed = true;
+}
+
+void gsync::tripwire::Disarm() { armed = false; }
+
+bool gsync::tripwire::Armed() { return armed; }
+
+void gsync::tripwire::CheckFaults() {
+    if (!armed) {
+        return;
+    }
+
+    long minflt = 0;
+    long majflt = 0;
+    ReadFaults(minflt, majflt);
+    const long kNewMinor = minflt - last_minflt;
+    const long kNewMajor = majflt - last_majflt;
+    last_minflt = minflt;
+    last_majflt = majflt;
+
+    if (kNewMajor > 0) {
+        major_faults += static_cast<uint64_t>(kNewMajor);
+        Report("major page faults", static_cast<std::size_t>(kNewMajor));
+    }
+    if (kNewMinor > 0) {
+        minor_faults += static_cast<uint64_t>(kNewMinor);
+        Report("minor page faults", static_cast<std::size_t>(kNewMinor));
+    }
+}
+
+gsync::tripwire::Trips gsync::tripwire::Count() {
+    return {
+        .allocations = allocations,
+        .frees = frees,
+        .minor_faults = minor_faults,
+        .major_faults = major_faults,
+    };
+}
+
+/* Interpose on the malloc() family. operator new and delete end up here as
+ * well. */
+extern "C" {
+
+void* malloc(std::size_t size) noexcept {
+    TripAlloc("malloc", size);
+    return __libc_malloc(size);
+}
+
+void* calloc(std::size_t nmemb, std::size_t size) noexcept {
+    TripAlloc("calloc", nmemb * size);
+    return __libc_calloc(nmemb, size);
+}
+
+void* realloc(void* ptr, std::size_t size) noexcept {
+    TripAlloc("realloc", size);
+    return __libc_realloc(ptr, size);
+}
+
+void* memalign(std::size_t alignment, std::size_t size) noexcept {
+    TripAlloc("memalign", size);
+    return __libc_memalign(alignment, size);
+}
+
+void* aligned_alloc(std::size_t alignment, std::size_t size) noexcept {
+    TripAlloc("aligned_alloc", size);
+    return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void** memptr, std::size_t alignment,
+                   std::size_t size) noexcept {
+    TripAlloc("posix_memalign", size);
+    if ((alignment < sizeof(void*)) || (alignment & (alignment - 1))) {
+        return EINVAL;
+    }
+    void* ptr = __libc_memalign(alignment, size);
+    if (!ptr) {
+        return ENOMEM;
+    }
+    *memptr = ptr;
+    return 0;
+}
+
+void free(void* ptr) noexcept {
+    if (ptr && armed.load(std::memory_order_relaxed) && !reporting) {
+        frees++;
+        Report("free", 0);
+    }
+    __libc_free(ptr);
+}
+
+}  // extern "C"
@@ -0,0 +1,19 @@
+#include "util/usdt/usdt.hpp"
+
+#if defined(GSYNC_USDT) && __has_include(<sys/sdt.h>)
+
+/* One semaphore per probe declared in usdt.hpp. Tracers find them through
+ * the probes' notes and increment them while attached. */
+#define GSYNC_DEFINE_PROBE_SEMAPHORE(name) \
+    volatile unsigned short gsync_##name##_semaphore = 0
+
+GSYNC_DEFINE_PROBE_SEMAPHORE(peer_read);
+GSYNC_DEFINE_PROBE_SEMAPHORE(phase_step);
+GSYNC_DEFINE_PROBE_SEMAPHORE(base_rate);
+GSYNC_DEFINE_PROBE_SEMAPHORE(compute_wakeup);
+GSYNC_DEFINE_PROBE_SEMAPHORE(sleep_enter);
+GSYNC_DEFINE_PROBE_SEMAPHORE(sleep_exit);
+GSYNC_DEFINE_PROBE_SEMAPHORE(edge_captured);
+GSYNC_DEFINE_PROBE_SEMAPHORE(publish);
+
+#endif
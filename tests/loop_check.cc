@@ -0,0 +1,188 @@
+#include <time.h>
+
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <variant>
+#include <vector>
+
+#include "sync/clock.hpp"
+#include "sync/estimator.hpp"
+#include "sync/filter.hpp"
+#include "sync/loop.hpp"
+#include "sync/overrun.hpp"
+#include "sync/phase.hpp"
+#include "sync/pll.hpp"
+#include "sync/probe.hpp"
+#include "util/gpio/backend.hpp"
+#include "util/gpio/resolve.hpp"
+#include "util/gpio/vgpio.hpp"
+#include "util/shmem/channel.hpp"
+#include "util/shmem/shmem.hpp"
+
+#include "loop_sim.hpp"
+
+/* Run a freshly built SyncLoop for \p cycles against a freshly built
+ * simulated peer. Record every cycle's actual and scheduled wakeup in
+ * \p schedule and count the cycles on which the loop fell back from tracking
+ * to free running in \p fallbacks. Throws std::runtime_error. */
+static void RecordSchedule(uint64_t cycles, std::vector<int64_t>& schedule,
+                           uint64_t& fallbacks) {
+    loop_sim::LoopIo io;
+    io.Open("gsync_check_reproducible", loop_sim::ShmemKey(0x6d70));
+    gsync::IpShMemData<struct timespec>* peer = io.shmem->GetData();
+
+    gsync::VirtualClock clock = loop_sim::MakeClock();
+    gsync::PllSync sync(loop_sim::MakeRate(), 0.25, 0.02);
+    gsync::PeerEstimator estimator = loop_sim::MakeEstimator();
+    gsync::MadFilter filter = loop_sim::MakeFilter();
+    gsync::SkipOverrun overrun;
+    gsync::VirtualGpioBackend& line = *std::get<gsync::VirtualGpioBackend*>(
+        gsync::ResolveBackend(*io.gpio));
+    gsync::ShMemChannel channel(peer);
+    gsync::NullProbe probe;
+    gsync::SyncLoop loop(clock, sync, estimator, filter, overrun,
+                         loop_sim::MakeLoopConfig(), line, channel, probe);
+
+    loop_sim::SimulatedPeer sim(clock.NowNano());
+    gsync::SyncState prev_state = loop.State();
+    schedule.clear();
+    fallbacks = 0;
+    for (uint64_t i = 0; i < cycles; ++i) {
+        sim.Publish(clock.NowNano(), peer);
+        loop.Step();
+        schedule.push_back(gsync::TsToNano(loop.LastWakeup()));
+        schedule.push_back(gsync::TsToNano(loop.NextWakeup()));
+        if ((prev_state == gsync::SyncState::kTrack) &&
+            (loop.State() == gsync::SyncState::kFreeRun)) {
+            fallbacks++;
+        }
+        prev_state = loop.State();
+    }
+}
+
+/* SyncLoop on a VirtualClock must yield the same schedule on every run,
+ * including across the simulated peer's offline windows. Run it twice and
+ * fail if the two schedules differ in any cycle, or if the peer never went
+ * offline while the loop was tracking it. */
+static bool CheckReproducible() {
+    const uint64_t kCycles = 20000;
+    std::vector<int64_t> first;
+    std::vector<int64_t> second;
+    first.reserve(2 * kCycles);
+    second.reserve(2 * kCycles);
+    uint64_t fallbacks = 0;
+    uint64_t second_fallbacks = 0;
+
+    RecordSchedule(kCycles, first, fallbacks);
+    RecordSchedule(kCycles, second, second_fallbacks);
+    if (first != second) {
+        for (size_t i = 0; i < first.size(); ++i) {
+            if (first[i] != second[i]) {
+                std::cerr << "error: SyncLoop schedule differs between runs "
+                          << "in cycle " << (i / 2) << std::endl;
+                break;
+            }
+        }
+        return false;
+    }
+    if (!fallbacks) {
+        std::cerr << "error: peer never went offline while tracked"
+                  << std::endl;
+        return false;
+    }
+    std::cout << kCycles << " cycles, " << fallbacks
+              << " fallbacks, same schedule on both runs" << std::endl;
+    return true;
+}
+
+/* The hand-written loop the benchmarks measure SyncLoop against is only a
+ * fair baseline if it runs the same schedule. Step the two in lockstep,
+ * against one simulated peer, and fail on the first cycle where their clocks
+ * disagree, or if they end up having decided differently. */
+static bool CheckMatchesBaseline() {
+    const uint64_t kCycles = 100000;
+    loop_sim::LoopIo io;
+    io.Open("gsync_check_baseline", loop_sim::ShmemKey(0x6e70));
+    gsync::IpShMemData<struct timespec>* peer = io.shmem->GetData();
+
+    gsync::VirtualClock clock = loop_sim::MakeClock();
+    gsync::PllSync sync(loop_sim::MakeRate(), 0.25, 0.02);
+    gsync::PeerEstimator estimator = loop_sim::MakeEstimator();
+    gsync::MadFilter filter = loop_sim::MakeFilter();
+    gsync::SkipOverrun overrun;
+    gsync::VirtualGpioBackend& line = *std::get<gsync::VirtualGpioBackend*>(
+        gsync::ResolveBackend(*io.gpio));
+    gsync::ShMemChannel channel(peer);
+    gsync::NullProbe probe;
+    gsync::SyncLoop loop(clock, sync, estimator, filter, overrun,
+                         loop_sim::MakeLoopConfig(), line, channel, probe);
+
+    gsync::VirtualClock base_clock = loop_sim::MakeClock();
+    gsync::PllSync base_sync(loop_sim::MakeRate(), 0.25, 0.02);
+    gsync::PeerEstimator base_estimator = loop_sim::MakeEstimator();
+    gsync::MadFilter base_filter = loop_sim::MakeFilter();
+    gsync::SkipOverrun base_overrun;
+    loop_sim::HandWrittenLoop baseline(
+        base_clock, base_sync, &base_estimator, &base_filter, base_overrun,
+        loop_sim::MakeLoopConfig(), *io.gpio, peer);
+
+    loop_sim::SimulatedPeer sim(clock.NowNano());
+    for (uint64_t i = 0; i < kCycles; ++i) {
+        sim.Publish(clock.NowNano(), peer);
+        loop.Step();
+        baseline.Step();
+        if (clock.NowNano() != base_clock.NowNano()) {
+            std::cerr << "error: hand-written loop diverged from SyncLoop in "
+                      << "cycle " << i << " by "
+                      << (base_clock.NowNano() - clock.NowNano()) << " ns"
+                      << std::endl;
+            return false;
+        }
+    }
+
+    const gsync::LoopTelemetry& telemetry = loop.Telemetry();
+    const gsync::LoopTelemetry& base_telemetry = baseline.Telemetry();
+    if ((telemetry.tracked_cycles != base_telemetry.tracked_cycles) ||
+        (telemetry.phase_steps != base_telemetry.phase_steps) ||
+        (filter.Rejected() != base_filter.Rejected())) {
+        std::cerr << "error: hand-written loop decided differently: "
+                  << base_telemetry.tracked_cycles << " tracked, "
+                  << base_telemetry.phase_steps << " steps, "
+                  << base_filter.Rejected() << " rejected vs. "
+                  << telemetry.tracked_cycles << ", "
+                  << telemetry.phase_steps << ", " << filter.Rejected()
+                  << std::endl;
+        return false;
+    }
+    std::cout << kCycles << " cycles, " << telemetry.tracked_cycles
+              << " tracked, " << telemetry.phase_steps << " steps, "
+              << filter.Rejected() << " rejected by both loops" << std::endl;
+    return true;
+}
+
+/* Run the loop check named by the only argument against a simulated peer in
+ * virtual time. */
+int main(int argc, char* argv[]) {
+    if (argc != 2) {
+        std::cerr << "usage: " << argv[0] << " reproducible|baseline"
+                  << std::endl;
+        return 1;
+    }
+
+    try {
+        if (!std::strcmp(argv[1], "reproducible")) {
+            return (CheckReproducible()) ? 0 : 1;
+        }
+        if (!std::strcmp(argv[1], "baseline")) {
+            return (CheckMatchesBaseline()) ? 0 : 1;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    std::cerr << "error: unknown check " << argv[1] << std::endl;
+    return 1;
+}
@@ -0,0 +1,259 @@
+#ifndef LOOP_SIM_H_
+#define LOOP_SIM_H_
+
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <optional>
+#include <string>
+
+#include "sync/clock.hpp"
+#include "sync/estimator.hpp"
+#include "sync/filter.hpp"
+#include "sync/loop.hpp"
+#include "sync/overrun.hpp"
+#include "sync/phase.hpp"
+#include "sync/rate.hpp"
+#include "sync/sync.hpp"
+#include "util/gpio/gpio.hpp"
+#include "util/shmem/shmem.hpp"
+
+/*
+ * A simulated peer and the rest of the test bench gsync's event loop is run
+ * against in virtual time, shared by the loop checks and the loop
+ * benchmarks.
+ */
+namespace loop_sim {
+
+const int64_t kPeriodNano = 10000000; /* 100 Hz. */
+
+/* Shared memory key derived from \p base and our PID. Keys must not collide
+ * with a running gtimer or with another check running in parallel. */
+inline int ShmemKey(int base) {
+    return base + static_cast<int>(getpid() % 1000);
+}
+
+/* A peer running off of a slightly fast oscillator, seen through a gtimer
+ * with a jittery capture latency. It drops off the bus for 100 of every 1000
+ * of its periods, which exercises the free running fallback and
+ * reacquisition. Everything is a function of virtual time, so every run is
+ * identical. */
+class SimulatedPeer {
+   public:
+    explicit SimulatedPeer(int64_t start_ns)
+        : next_ns_(start_ns + kPeriodNano / 3), periods_(0), state_(1) {}
+
+    /* Publish every peer wakeup up to \p now_ns to \p peer. */
+    void Publish(int64_t now_ns, gsync::IpShMemData<struct timespec>* peer) {
+        const int64_t kPeerPeriodNano = kPeriodNano + 500; /* +50 ppm. */
+        const int64_t kLatencyNano = 20000;
+        const uint64_t kOfflineStart = 600;
+        const uint64_t kOfflineEnd = 700;
+
+        while (next_ns_ <= now_ns) {
+            uint64_t phase = periods_ % 1000;
+            if ((phase < kOfflineStart) || (phase >= kOfflineEnd)) {
+                peer->Lock();
+                peer->data =
+                    gsync::NanoToTs(next_ns_ + kLatencyNano + Jitter());
+                peer->Unlock();
+            }
+            next_ns_ += kPeerPeriodNano;
+            periods_++;
+        }
+    }
+
+   private:
+    /* Uniform jitter in [0, 16384) ns. */
+    int64_t Jitter() {
+        state_ = state_ * 6364136223846793005ULL + 1442695040888963407ULL;
+        return static_cast<int64_t>(state_ >> 50);
+    }
+
+    int64_t next_ns_;
+    uint64_t periods_;
+    uint64_t state_;
+};
+
+/* Shared memory slot and vgpio line every loop under test runs against. */
+struct LoopIo {
+    std::unique_ptr<gsync::IpShMem<struct timespec>> shmem;
+    std::unique_ptr<gsync::Gpio> gpio;
+
+    /* Open a cleared slot at \p shmem_key and line 0 of vgpio bus \p bus.
+     * Throws std::runtime_error. */
+    void Open(const std::string& bus, int shmem_key) {
+        shmem = std::make_unique<gsync::IpShMem<struct timespec>>(shmem_key);
+        shmem->GetData()->data = {};
+        gpio = std::make_unique<gsync::Gpio>("vgpio:" + bus, 0);
+        gpio->Dir(gsync::Gpio::Direction::kOutput);
+    }
+};
+
+/* The event loop as it was written before SyncLoop was composed of
+ * policies: the controller and GPIO backend sit behind virtual calls and the
+ * optional estimator and filter behind null checks. Kept as a speed baseline
+ * for the policy-based loop. It runs exactly the same schedule as SyncLoop
+ * given the same LoopConfig, the loop_matches_baseline check makes sure of
+ * that, so the items/s of the two compare like for like. */
+class HandWrittenLoop {
+   public:
+    HandWrittenLoop(gsync::VirtualClock& clock, gsync::SyncController& sync,
+                    gsync::PeerEstimator* estimator, gsync::MadFilter* filter,
+                    gsync::SkipOverrun& overrun,
+                    const gsync::LoopConfig& config, gsync::Gpio& gpio,
+                    gsync::IpShMemData<struct timespec>* peer)
+        : clock_(clock),
+          sync_(sync),
+          estimator_(estimator),
+          filter_(filter),
+          overrun_(overrun),
+          gpio_(gpio),
+          peer_(peer),
+          period_ns_(sync.Rate().NominalPeriod()),
+          max_step_ns_(static_cast<int64_t>(
+              config.max_step * static_cast<double>(period_ns_))),
+          latency_ns_(config.latency_ns) {}
+
+    const gsync::LoopTelemetry& Telemetry() const { return telemetry_; }
+
+    void Step() {
+        const int kMaxMissedCycles = 3;
+        const int64_t kReacquireNano = period_ns_ / 4;
+        const timespec kEmptyTs = {.tv_sec = 0, .tv_nsec = 0};
+        auto TsEqual = [](const timespec& a, const timespec& b) {
+            return ((a.tv_sec == b.tv_sec) && (a.tv_nsec == b.tv_nsec));
+        };
+
+        gpio_.Val(gsync::Gpio::Value::kHigh);
+        actual_wakeup_ = clock_.Now();
+        peer_->Lock();
+        timespec peer_wakeup = peer_->data;
+        peer_->Unlock();
+
+        bool is_fresh = !TsEqual(kEmptyTs, peer_wakeup) &&
+                        !TsEqual(prev_peer_wakeup_, peer_wakeup);
+        missed_cycles_ = (is_fresh) ? 0 : (missed_cycles_ + 1);
+        if (missed_cycles_ >= kMaxMissedCycles) {
+            state_ = gsync::SyncState::kFreeRun;
+        }
+        bool is_trusted =
+            is_fresh &&
+            gsync::IsTrustedSample(peer_wakeup, prev_peer_wakeup_, period_ns_);
+        int64_t phase_err = gsync::PhaseErrorNano(
+            actual_wakeup_,
+            gsync::NanoToTs(gsync::TsToNano(peer_wakeup) - latency_ns_),
+            period_ns_);
+        if ((state_ == gsync::SyncState::kTrack) && is_trusted &&
+            (std::abs(phase_err) > kReacquireNano)) {
+            state_ = gsync::SyncState::kAcquire;
+        }
+
+        bool stepped = false;
+        if (is_fresh && (state_ != gsync::SyncState::kTrack)) {
+            if ((state_ == gsync::SyncState::kAcquire) && is_trusted &&
+                (phase_err >= 0)) {
+                new_wakeup_ = gsync::NanoToTs(
+                    gsync::TsToNano(sync_.NominalWakeup(actual_wakeup_)) +
+                    std::min(phase_err, max_step_ns_));
+                if (estimator_) {
+                    estimator_->Reset();
+                }
+                if (filter_) {
+                    filter_->Reset();
+                }
+                if (phase_err <= max_step_ns_) {
+                    state_ = gsync::SyncState::kTrack;
+                }
+                stepped = true;
+                telemetry_.phase_steps++;
+            } else if ((state_ == gsync::SyncState::kAcquire) && is_trusted &&
+                       (phase_err >= -kReacquireNano)) {
+                state_ = gsync::SyncState::kTrack;
+            } else {
+                state_ = gsync::SyncState::kAcquire;
+            }
+        }
+
+        std::optional<int64_t> filtered_err;
+        if (is_fresh && !stepped && (state_ == gsync::SyncState::kTrack)) {
+            filtered_err = (filter_) ? filter_->Filter(phase_err)
+                                     : std::optional<int64_t>(phase_err);
+        }
+
+        if (stepped) {
+        } else if (!filtered_err) {
+            new_wakeup_ = sync_.NominalWakeup(
+                TsEqual(kEmptyTs, new_wakeup_) ? actual_wakeup_ : new_wakeup_);
+            telemetry_.base_rate_cycles++;
+        } else {
+            timespec peer_sample = gsync::NanoToTs(
+                gsync::TsToNano(actual_wakeup_) + *filtered_err);
+            timespec peer_estimate =
+                (estimator_) ? estimator_->Update(peer_sample) : peer_sample;
+            new_wakeup_ = sync_.ComputeNewWakeup(actual_wakeup_, peer_estimate);
+            telemetry_.tracked_cycles++;
+        }
+        prev_peer_wakeup_ = peer_wakeup;
+        telemetry_.cycles++;
+        gpio_.Val(gsync::Gpio::Value::kLow);
+
+        clock_.SleepUntil(
+            overrun_.Apply(new_wakeup_, clock_.Now(), period_ns_));
+    }
+
+   private:
+    gsync::VirtualClock& clock_;
+    gsync::SyncController& sync_;
+    gsync::PeerEstimator* estimator_;
+    gsync::MadFilter* filter_;
+    gsync::SkipOverrun& overrun_;
+    gsync::Gpio& gpio_;
+    gsync::IpShMemData<struct timespec>* peer_;
+    int64_t period_ns_;
+    int64_t max_step_ns_;
+    int64_t latency_ns_;
+    timespec actual_wakeup_ = {};
+    timespec new_wakeup_ = {};
+    timespec prev_peer_wakeup_ = {};
+    gsync::SyncState state_ = gsync::SyncState::kFreeRun;
+    int missed_cycles_ = 0;
+    gsync::LoopTelemetry telemetry_;
+};
+
+inline gsync::VirtualClock MakeClock() {
+    const int64_t kWakeupLatencyNano = 50000;
+    return gsync::VirtualClock(gsync::kNanoPerSec, kWakeupLatencyNano);
+}
+
+/* Loop parameters shared by every loop under test. The latency matches the
+ * simulated peer's. */
+inline gsync::LoopConfig MakeLoopConfig() {
+    return gsync::LoopConfig{
+        .max_step = 0.25,
+        .latency_ns = 20000,
+    };
+}
+
+inline gsync::SyncRate MakeRate() {
+    return gsync::SyncRate::FromPeriodNs(kPeriodNano);
+}
+
+inline gsync::PeerEstimator MakeEstimator() {
+    return gsync::PeerEstimator(MakeRate(),
+                                gsync::PeerEstimator::Config{
+                                    .measurement_noise_ns = 20000.0,
+                                    .phase_noise_ns = 2000.0,
+                                    .period_noise_ns = 20.0,
+                                });
+}
+
+inline gsync::MadFilter MakeFilter() { return gsync::MadFilter(5, 3.0); }
+
+}  // namespace loop_sim
+
+#endif
@@ -0,0 +1,40 @@
+#include <cstdint>
+#include <iostream>
+
+#include "sync/phase.hpp"
+#include "sync/rate.hpp"
+
+/* Hand out \p periods periods at num/den Hz and check that after every one of
+ * them the schedule is the exact one rounded down. The exact sum of n periods
+ * is n * 1e9 * den / num, split into whole and fractional nanoseconds so that
+ * it fits in 64 bits. */
+static bool CheckDrift(int64_t num, int64_t den, int64_t periods) {
+    const int64_t kWhole = (gsync::kNanoPerSec * den) / num;
+    const int64_t kRemainder = (gsync::kNanoPerSec * den) % num;
+
+    gsync::SyncRate rate = gsync::SyncRate::FromHz(num, den);
+    int64_t elapsed = 0;
+    for (int64_t n = 1; n <= periods; ++n) {
+        elapsed += rate.NextPeriod();
+        int64_t exact = (n * kWhole) + ((n * kRemainder) / num);
+        if (elapsed != exact) {
+            std::cerr << "error: " << num << "/" << den << " Hz drifted by "
+                      << (elapsed - exact) << " ns after " << n << " periods"
+                      << std::endl;
+            return false;
+        }
+    }
+    std::cout << num << "/" << den << " Hz: " << periods
+              << " periods, no drift" << std::endl;
+    return true;
+}
+
+/* Check the dithered schedule of SyncRate::NextPeriod() against the exact
+ * one over 1e8 periods of rates with and without an integer period. */
+int main() {
+    const int64_t kPeriods = 100000000;
+    bool ok = CheckDrift(2997, 100, kPeriods);      /* 29.97 Hz. */
+    ok = CheckDrift(30000, 1001, kPeriods) && ok; /* NTSC. */
+    ok = CheckDrift(10000, 1, kPeriods) && ok;    /* 10 kHz. */
+    return (ok) ? 0 : 1;
+}